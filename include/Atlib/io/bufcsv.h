@@ -0,0 +1,120 @@
+#ifndef __ATLIB_BUFCSV_H
+#define __ATLIB_BUFCSV_H
+
+/**
+ * @file bufcsv.h
+ * @brief Tokenizes delimited records (CSV, TSV, ...) straight out of a @c bufread_t buffer.
+ */
+
+#include "Atlib/types.h"
+#include "Atlib/io/bufread.h"
+
+/**
+ * @brief A streaming tokenizer of delimited records over a @c bufread_t.
+ *
+ * Each call to @ref atlib_bufcsv_next splits the next record into @c fields, which are
+ * views straight into the buffer of @c br. No field is ever copied.
+ *
+ * Records end at the first @c '\n' outside of quotes, and a @c '\r' right before it is
+ * dropped. Fields are separated by @c delim, also outside of quotes. Fields enclosed in
+ * @c quote have the enclosing quotes removed from their view, but a doubled quote inside
+ * one (@c "") is left as it is; see @ref atlib_bufcsv_unquote.
+ *
+ * @warning The views in @c fields are invalidated by the next call that reads, moves, or
+ * closes @c br, including the next call to @ref atlib_bufcsv_next.
+ *
+ * @see atlib_bufcsv_open
+ * @see atlib_bufcsv_close
+ */
+typedef struct {
+    bufread_t * br;                     ///< @brief The stream to read records from.
+    bufview_t * fields;                 ///< @brief The fields of the last record read.
+    usize nfields;                      ///< @brief The number of fields in @c fields.
+    usize cap;                          ///< @brief The capacity of @c fields.
+    char delim;                         ///< @brief The byte separating fields, i.e. @c ',' or @c '\t'.
+    char quote;                         ///< @brief The byte enclosing quoted fields, or @c '\0' if fields are never quoted.
+} bufcsv_t;
+
+/**
+ * @brief Initializes @c csv to tokenize the records of @c br.
+ * @param csv Pointer to a @c bufcsv_t object.
+ * @param br Pointer to a valid @c bufread_t object to read records from.
+ * @param delim The byte separating fields, i.e. @c ',' for CSV or @c '\t' for TSV. Must not be @c '\n'.
+ * @param quote The byte enclosing quoted fields, usually @c '"', or @c '\0' to disable quoting.
+ * Must differ from @c delim.
+ * @returns Pointer to @c csv on success, or @c nullptr if an error occured.
+ *
+ * @c br is not owned by @c csv, and must stay open until @c csv is closed. Reading @c br
+ * directly between records is allowed.
+ *
+ * Example:
+ * @code{.c}
+ * bufread_t br;
+ * bufcsv_t csv;
+ * atlib_bufread_open(&br, "trades.csv", BUFREAD_MMAP);
+ * atlib_bufcsv_open(&csv, &br, ',', '"');
+ *
+ * while(atlib_bufcsv_next(&csv) > 0) {
+ *     for(usize i = 0; i < csv.nfields; i++) {
+ *         /\* Use csv.fields[i].ptr and csv.fields[i].len *\/
+ *     }
+ * }
+ *
+ * atlib_bufcsv_close(&csv);
+ * atlib_bufread_close(&br);
+ * @endcode
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI bufcsv_t * atlib_bufcsv_open(bufcsv_t *__restrict csv, bufread_t *__restrict br, char delim, char quote);
+
+/**
+ * @brief Releases @c csv. The stream it reads from is left open.
+ * @param csv Pointer to a valid @c bufcsv_t object.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI void atlib_bufcsv_close(bufcsv_t * csv);
+
+/**
+ * @brief Reads the next record of @c csv, and splits it into @c csv->fields.
+ * @param csv Pointer to a valid @c bufcsv_t object.
+ * @returns 1 if a record was read, 0 once the stream has no more data, or -1 if @c fields
+ * could not grow to hold the record, in which case the record is left unread.
+ *
+ * The record is scanned 64 bytes at a time. For each block, bitmasks of the quotes,
+ * delimiters, and newlines in it are built with vector compares (AVX2 or SSE2 when
+ * available, scalar otherwise). A prefix XOR of the quote mask, carried from block to
+ * block, marks every byte inside quotes, and what remains of the delimiter and newline
+ * masks are exactly the field and record boundaries, which are then walked bit by bit.
+ * No byte is looked at one at a time.
+ *
+ * A record that spans a refill of the stream, quoted or not, is simply scanned again from
+ * its start once more data is buffered. The buffer of the stream only grows when a single
+ * record is larger than the whole buffer.
+ *
+ * Every record has at least one field; an empty line gives a single empty field. The last
+ * record is returned even if it is not followed by a newline.
+ *
+ * @warning As in most vectorized tokenizers, every @c quote toggles quoting, including a
+ * stray one in the middle of an unquoted field. Such input is not valid CSV.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI i32 atlib_bufcsv_next(bufcsv_t * csv);
+
+/**
+ * @brief Copies @c field into @c dst, collapsing every doubled quote into a single one.
+ * @param csv Pointer to a valid @c bufcsv_t object that @c field came from.
+ * @param field A field of the last record read from @c csv.
+ * @param dst Buffer of at least @c field.len bytes.
+ * @returns The length of the unquoted field written to @c dst.
+ *
+ * Only needed for quoted fields that contain the quote character itself; any other
+ * field can be used straight from its view.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufcsv_unquote(const bufcsv_t *__restrict csv, bufview_t field, char *__restrict dst);
+
+#endif
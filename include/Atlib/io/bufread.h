@@ -7,6 +7,8 @@
  */
 
 #include "Atlib/types.h"
+#include "Atlib/io/bufread_flags.h"
+#include "Atlib/io/uring.h"
 #include <fcntl.h>
 #include <bits/types/FILE.h>
 #include <stdio.h>
@@ -55,7 +57,15 @@
  * @b NOT specified).
  *
  * The internal buffer's size is controlled by the macro @ref __ATLIB_BUFREAD_SIZE,
- * which defaults to '4096', or the size of a standard memory page. 
+ * which defaults to '4096', or the size of a standard memory page. A single stream
+ * can use a buffer of any other capacity through @ref atlib_bufread_setbuf.
+ *
+ * When opened with @ref BUFREAD_MMAP, the whole file is mapped into memory instead,
+ * and the internal buffer is left unused; @c base and @c cap then describe the
+ * mapping, which @c next and @c to_read walk directly.
+ *
+ * When opened with @ref BUFREAD_READAHEAD, a helper thread reads into a second buffer
+ * while the current one is consumed, and the two are swapped on each refill.
  *
  * @warning A valid Buffered Reader, or `bufread_t` object, is any Buffered Reader
  * that has been initialized (see @see atlib_bufread_open or @see atlib_bufread_fopen).
@@ -64,14 +74,43 @@
  * @see atlib_bufread_open
  * @see atlib_bufread_close
  */
+struct __bufread_ahead;
+
 typedef struct {
-    FILE * fh;                      ///< @brief The FILE handler to read from.
+    FILE * fh;                      ///< @brief The FILE handler to read from, or @c nullptr when opened with @ref BUFREAD_FD.
+    i32 fd;                         ///< @brief The file descriptor to read from.
     isize to_read;                  ///< @brief The number of unread bytes in the buffer before the next refill.
     u32 flags;                      ///< @brief Flags used to track extra features of this buffered reader.
+    usize off;                      ///< @brief The file position of the byte just past the end of the buffer.
     char * next;                    ///< @brief The pointer to the next byte to read.
-    char buf[__ATLIB_BUFREAD_SIZE]; ///< @brief The buffer to store data.
+    char * base;                    ///< @brief The start of the buffer in use; @c buf unless replaced, or the file mapping.
+    usize cap;                      ///< @brief The capacity of the buffer in use, in bytes.
+    usize lim;                      ///< @brief The file position reading stops at; the end of the range for ranged streams.
+    usize drop;                     ///< @brief The file position before which cached pages have been released, with @ref BUFREAD_NOREUSE.
+    struct __bufread_ahead * ahead; ///< @brief The background read-ahead state, or @c nullptr when not reading ahead.
+    struct __bufread_cache * cache; ///< @brief The block cache, or @c nullptr when not caching; see @ref atlib_bufread_cache.
+    char buf[__ATLIB_BUFREAD_SIZE]; ///< @brief The default buffer to store data.
 } bufread_t;
 
+/**
+ * @brief A read-only view of bytes held inside a buffered stream.
+ *
+ * A view does not own its bytes. It stays valid only until the next call that reads,
+ * moves, or closes the stream it came from.
+ */
+typedef struct {
+    const char * ptr;               ///< @brief The first byte of the view.
+    usize len;                      ///< @brief The number of bytes in the view.
+} bufview_t;
+
+/**
+ * @brief A half-open range of byte positions, [start, end), within a file.
+ */
+typedef struct {
+    usize start;                    ///< @brief The position of the first byte in the range.
+    usize end;                      ///< @brief The position just past the last byte in the range.
+} bufrange_t;
+
 /**
  * @brief Initializes a @c bufread_t object to a valid state.
  * @param br A pointer to a @c bufread_t object.
@@ -81,6 +120,24 @@ typedef struct {
  *
  * The file specified by in @c file_path is opened in read-only mode.
  *
+ * If @c br_flags contains @ref BUFREAD_MMAP, the file is mapped into memory
+ * and every read is served straight from the mapping. Skipping, rewinding,
+ * and seeking become simple pointer arithmetic. If the file cannot be mapped
+ * (i.e. it is a pipe or empty), @c br silently falls back to buffered reading.
+ *
+ * If @c br_flags contains @ref BUFREAD_FD, the file is opened with @c open(2)
+ * and read with @c read(2) straight into the internal buffer, bypassing stdio.
+ *
+ * The access pattern hints (@ref BUFREAD_SEQUENTIAL, @ref BUFREAD_RANDOM,
+ * @ref BUFREAD_NOREUSE, and @ref BUFREAD_WILLNEED) are passed on to the kernel
+ * when the file is opened. They never change what is read, only how well the
+ * page cache serves it.
+ *
+ * If @c br_flags contains @ref BUFREAD_READAHEAD, the next block of the file is
+ * read on a background thread while the current one is consumed, overlapping
+ * disk latency with the caller's own work. Memory use doubles, and the internal
+ * buffer is replaced by two allocated ones.
+ *
  * To initialize a @c bufread_t from a FILE pointer instead, use
  * @ref atlib_bufread_fopen instead.
  *
@@ -178,6 +235,119 @@ ATAPI bufread_t * atlib_bufread_open(bufread_t *__restrict br, const char *__res
  */
 ATAPI bufread_t * atlib_bufread_fopen(bufread_t *__restrict br, FILE *__restrict file);
 
+/**
+ * @brief Initializes a @c bufread_t object to read from the file descriptor @c fd.
+ * @param br Pointer to a @c bufread_t object.
+ * @param fd An open file descriptor, readable with @c read(2).
+ * @param br_flags Flags for this buffered stream. See @see bufread_flags.h for more information.
+ * @returns Pointer to @c br on success, or @c nullptr if an error occured.
+ *
+ * The stream reads from @c fd with @c read(2), bypassing stdio; @ref BUFREAD_FD is
+ * always set. Reading starts at the current offset of @c fd, unless @ref BUFREAD_MMAP
+ * is set, in which case the whole file is mapped from its start.
+ *
+ * @warning The caller is responsible for closing @c fd, just as with
+ * @ref atlib_bufread_fopen.
+ *
+ * @see atlib_bufread_open
+ * @see atlib_bufread_close
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI bufread_t * atlib_bufread_fdopen(bufread_t * br, i32 fd, u32 br_flags);
+
+/**
+ * @brief Initializes a @c bufread_t object to read the @c len bytes at @c mem.
+ * @param br Pointer to a @c bufread_t object.
+ * @param mem The bytes to read. Must stay valid, and unchanged, until @c br is closed.
+ * @param len The number of bytes at @c mem.
+ * @param br_flags Flags for this buffered stream. Only @ref BUFREAD_READ_BE and
+ * @ref BUFREAD_READ_LE apply; see @see bufread_flags.h for more information.
+ * @returns Pointer to @c br.
+ *
+ * Every read is served straight from @c mem, without a copy into the internal buffer
+ * and without any system call, so any buffer held in memory (i.e. a network payload)
+ * can be decoded with the same functions as a file. Views handed out by @c br point
+ * into @c mem itself. Seeking anywhere within @c mem is simple pointer arithmetic.
+ *
+ * @c mem is never written to, nor freed by @c br.
+ *
+ * @see atlib_bufwrite_memopen
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI bufread_t * atlib_bufread_memopen(bufread_t *__restrict br, const void *__restrict mem, usize len, u32 br_flags);
+
+/**
+ * @brief Initializes @c br to read only the bytes of @c file_path within @c range.
+ * @param br A pointer to a @c bufread_t object.
+ * @param file_path The path of the file to open.
+ * @param range The range of the file to read. Reading starts at @c range.start.
+ * @param br_flags Flags for this buffered stream. See @see bufread_flags.h for more information.
+ * @returns Pointer to @c br on success, or @c nullptr if an error occured.
+ *
+ * Behaves as @ref atlib_bufread_open, except that @c br reaches its end of file at
+ * @c range.end, and cannot seek past it. Ranges are typically produced by
+ * @ref atlib_bufread_split, so that several streams can share one file, each on
+ * its own thread.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI bufread_t * atlib_bufread_open_range(bufread_t *__restrict br, const char *__restrict file_path, bufrange_t range, u32 br_flags);
+
+/**
+ * @brief Moves @c br onto @c ring, so that its reads are queued there instead of made directly.
+ * @param br Pointer to a valid @c bufread_t object, opened with @ref BUFREAD_FD.
+ * @param ring Pointer to a valid @c uring_t object.
+ * @returns Pointer to @c br on success, or @c nullptr if @c br cannot use @c ring, in which case it is left unchanged.
+ *
+ * From then on, @c br reads ahead like a stream opened with @ref BUFREAD_READAHEAD, but without a
+ * helper thread. The read of the next block is queued on @c ring as soon as the previous one has been
+ * consumed, and reaches the kernel together with those of every other stream on @c ring, the next time
+ * @ref atlib_uring_submit is called, or a stream has to wait on its own read.
+ *
+ * Only streams opened with @ref BUFREAD_FD, and neither mapped nor cached, can be moved onto a ring. Once moved,
+ * the buffer of @c br can no longer be replaced through @ref atlib_bufread_setbuf.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI bufread_t * atlib_bufread_uring(bufread_t * br, uring_t * ring);
+
+/**
+ * @brief Attaches a cache of the @c n most recently used blocks of its file to @c br.
+ * @param br Pointer to a valid @c bufread_t object.
+ * @param n The number of blocks to keep. Must be non-zero.
+ * @param block The size of each block, in bytes, or 0 for the capacity of the buffer of @c br.
+ * @returns Pointer to @c br on success, or @c nullptr if the cache could not be allocated, or
+ * @c br cannot be cached, in which case it is left unchanged.
+ *
+ * Without a cache, a seek that leaves the buffer throws it away, and the next read fetches
+ * a whole buffer from the file again, even if those bytes were just read. With a cache, the
+ * file is read in aligned blocks of @c block bytes, with @c pread(2), and the @c n most
+ * recently used blocks are kept. Refills, and seeks, skips, and rewinds that land in one of
+ * them, are then served straight from memory. Lookups scan the blocks in order, so @c n is
+ * best kept small, in the tens.
+ *
+ * This suits index-then-fetch lookups that jump back and forth within a small working set.
+ * Pair it with @ref BUFREAD_RANDOM, so the kernel does not read ahead of each block.
+ *
+ * Streams opened with @ref BUFREAD_MMAP, or over memory, already serve every read from
+ * memory, and are returned unchanged. Streams reading ahead, or over a pipe or any other
+ * file that cannot be read at an offset, cannot be cached. The cache is freed by
+ * @ref atlib_bufread_close. Since blocks are read at their own offset, the position of the
+ * underlying file is left where it was when the cache was attached.
+ *
+ * Example:
+ * @code{.c}
+ * bufread_t br;
+ * if(atlib_bufread_open(&br, "index.bin", BUFREAD_FD | BUFREAD_RANDOM) == nullptr) { /\* Handle Error Here *\/ }
+ * if(atlib_bufread_cache(&br, 32, 0) == nullptr) { /\* Handle Error Here *\/ }
+ * @endcode
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI bufread_t * atlib_bufread_cache(bufread_t * br, usize n, usize block);
+
 /**
  * @brief Closes and invalidates a @c bufread_t object.
  * @param br Pointer to @c bufread_t object to close.
@@ -220,6 +390,37 @@ ATAPI bufread_t * atlib_bufread_fopen(bufread_t *__restrict br, FILE *__restrict
  */
 ATAPI void atlib_bufread_close(bufread_t * br);
 
+/**
+ * @brief Replaces the buffer of @c br with one of @c cap bytes.
+ * @param br Pointer to a valid @c bufread_t object.
+ * @param buf Pointer to a buffer of at least @c cap bytes, or @c nullptr to have AtLib allocate one.
+ * @param cap Capacity of the new buffer, in bytes. Must be non-zero.
+ * @returns Pointer to @c br on success, or @c nullptr if the buffer could not be allocated,
+ * or the bytes still unread in @c br do not fit in @c cap.
+ *
+ * This is AtLib's reflection of glibc's @c setvbuf, and is best called right after opening
+ * @c br. It lets one program pair a large buffer for a bulk scan with small buffers for
+ * many short streams, without changing @ref __ATLIB_BUFREAD_SIZE. Any bytes still unread
+ * are carried over into the new buffer.
+ *
+ * A buffer allocated by AtLib is freed by @ref atlib_bufread_close. A buffer supplied by the
+ * caller must outlive @c br, and remains the caller's to free. Streams opened with
+ * @ref BUFREAD_MMAP do not use a buffer, and are returned unchanged.
+ *
+ * Streams opened with @ref BUFREAD_READAHEAD can only have their buffer replaced
+ * before the first read; afterwards, @c nullptr is returned.
+ *
+ * Example:
+ * @code{.c}
+ * bufread_t * br = /\* ... *\/;
+ * if(atlib_bufread_open(br, "dump.bin", 0) == nullptr) { /\* Handle Error Here *\/ }
+ * if(atlib_bufread_setbuf(br, nullptr, 1 << 20) == nullptr) { /\* Handle Error Here *\/ }
+ * @endcode
+ *
+ * @since AtLib v1.1.0
+ */
+extern bufread_t * atlib_bufread_setbuf(bufread_t *__restrict br, void *__restrict buf, usize cap) __attribute__((nonnull(1)));
+
 /**
  * @brief Reads at most @c n bytes from @c br into @c buf, or until @c '\n' has been encountered.
  * @param br Pointer to a valid @c bufread_t object to read from.
@@ -235,6 +436,118 @@ ATAPI void atlib_bufread_close(bufread_t * br);
  */
 ATAPI i64 atlib_bufread_read_nline(bufread_t *__restrict br, void *__restrict buf, u32 n);
 
+/**
+ * @brief Provides a view of the next line of @c br, without copying it.
+ * @param br Pointer to a valid @c bufread_t object to read from.
+ * @param line Pointer to a view to point at the line. The trailing @c '\n' is not included.
+ * @returns Non-zero if a line was read, or zero once @c br has no more data.
+ *
+ * Equal to @c atlib_bufread_next_delim(br, "\n", 1, line). See @ref atlib_bufread_next_delim.
+ *
+ * Example:
+ * @code{.c}
+ * bufread_t * br = /\* ... *\/;
+ * bufview_t line;
+ * while(atlib_bufread_next_line(br, &line)) {
+ *     /\* Use line.ptr and line.len *\/
+ * }
+ * @endcode
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI i32 atlib_bufread_next_line(bufread_t *__restrict br, bufview_t *__restrict line);
+
+/**
+ * @brief Provides a view of the next record of @c br that ends with @c delim, without copying it.
+ * @param br Pointer to a valid @c bufread_t object to read from.
+ * @param delim The delimiter that ends each record, i.e. @c "\n", @c "\r\n", or @c "" for @c '\0'.
+ * @param dlen Length of @c delim, in bytes. Must be non-zero.
+ * @param rec Pointer to a view to point at the record. The delimiter is not included.
+ * @returns Non-zero if a record was read, or zero once @c br has no more data.
+ *
+ * Delimiters are found with vectorized scanning (AVX2 or SSE2 when available, scalar otherwise),
+ * and each record is handed out as a view straight into the buffer of @c br. The buffer is only
+ * compacted when a record spans a refill, and only grows when a single record is larger than the
+ * whole buffer. The last record is returned even if it is not followed by a delimiter.
+ *
+ * @warning The view is invalidated by the next call that reads, moves, or closes @c br.
+ *
+ * @see atlib_bufread_next_line
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI i32 atlib_bufread_next_delim(bufread_t *__restrict br, const char *__restrict delim, usize dlen, bufview_t *__restrict rec);
+
+/**
+ * @brief Refills @c br after its unread bytes, doubling the buffer first if they already fill it. Internal to AtLib.
+ * @returns The number of bytes added, or 0 once @c br has no more data or the buffer cannot grow.
+ *
+ * The unread bytes may be moved, so any pointer into the buffer of @c br is invalidated.
+ */
+extern isize __atlib_bufread_more(bufread_t * br) __attribute__((nonnull, nothrow));
+
+/**
+ * @brief Parses the unsigned decimal integer at the position of @c br, skipping whitespace before it.
+ * @param br Pointer to a valid @c bufread_t object to read from.
+ * @param out Pointer to store the value in.
+ * @returns 1 if a number was parsed, 0 once @c br has no more data, or -1 if the next text is
+ * not a number, or the number does not fit in a @c u64.
+ *
+ * Digits are converted straight from the buffer of @c br, eight at a time with SWAR
+ * arithmetic where possible, with no intermediate copy. A number that straddles a refill
+ * is carried across it.
+ *
+ * If the next text is not a number, only the whitespace before it is consumed. A number too
+ * large for a @c u64 is consumed in full, and @c out is set to @c UINT64_MAX.
+ *
+ * Example:
+ * @code{.c}
+ * u64 v, sum = 0;
+ * while(atlib_bufread_parse_u64(bufstdin, &v) > 0) sum += v;
+ * @endcode
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI i32 atlib_bufread_parse_u64(bufread_t *__restrict br, u64 *__restrict out);
+
+/**
+ * @brief Parses the signed decimal integer at the position of @c br, skipping whitespace before it.
+ * @param br Pointer to a valid @c bufread_t object to read from.
+ * @param out Pointer to store the value in.
+ * @returns 1 if a number was parsed, 0 once @c br has no more data, or -1 if the next text is
+ * not a number, or the number does not fit in an @c i64.
+ *
+ * Behaves as @ref atlib_bufread_parse_u64, but accepts a leading @c '+' or @c '-'. A number out
+ * of range is consumed in full, and @c out is set to @c INT64_MIN or @c INT64_MAX.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI i32 atlib_bufread_parse_i64(bufread_t *__restrict br, i64 *__restrict out);
+
+/**
+ * @brief Parses the floating-point number at the position of @c br, skipping whitespace before it.
+ * @param br Pointer to a valid @c bufread_t object to read from.
+ * @param out Pointer to store the value in.
+ * @returns 1 if a number was parsed, 0 once @c br has no more data, or -1 if the next text is not a number.
+ *
+ * Accepts decimal numbers with an optional sign, fraction, and exponent, as well as @c "inf"
+ * and @c "nan". The result is always correctly rounded. Numbers with at most 19 significant
+ * digits, whose value is an exact double times an exact power of ten (i.e. most prices,
+ * measurements, and coordinates), are converted with a single multiply or divide. Anything
+ * else is handed to @c strtod.
+ *
+ * The number is parsed in place. If it straddles a refill, the buffer is compacted first; a
+ * number larger than the whole buffer is gathered on the stack instead, so the buffer never
+ * grows for it. A run of number characters longer than 800 bytes is skipped, and reported as
+ * not a number.
+ *
+ * @warning Hexadecimal floats are not recognized, and @c strtod is assumed to run in the
+ * "C" locale.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI i32 atlib_bufread_parse_f64(bufread_t *__restrict br, f64 *__restrict out);
+
 /*
  * @brief Reads @c n bytes from @c br into @c buf.
  * @param br Pointer to a valid @c bufread_t object to read from.
@@ -282,6 +595,81 @@ ATAPI __attribute__((deprecated)) i64 atlib_bufread_readn(bufread_t *__restrict
  */
 ATAPI u32 atlib_bufread_read(bufread_t *__restrict br, void *__restrict buf, u32 blk, u32 n);
 
+/**
+ * @brief Provides a view of the next @c n bytes of @c br, without consuming or copying them.
+ * @param br Pointer to a valid @c bufread_t object to peek into.
+ * @param n The number of bytes to view.
+ * @returns A view into the buffer of @c br. Its length is less than @c n only if @c EOF was
+ * encountered, or @c n is larger than the capacity of @c br.
+ *
+ * The buffer is only compacted and refilled when fewer than @c n bytes are buffered, so peeking
+ * at data that is already buffered is free. This lets a parser inspect headers and tokens in place,
+ * and then advance past them with @ref atlib_bufread_consume.
+ *
+ * Example:
+ * @code{.c}
+ * bufread_t * br = /\* ... *\/;
+ * bufview_t v = atlib_bufread_peek(br, 4);
+ * if(v.len == 4 && memcmp(v.ptr, "RIFF", 4) == 0) atlib_bufread_consume(br, 4);
+ * @endcode
+ *
+ * @warning The view is invalidated by the next call that reads, moves, or closes @c br.
+ *
+ * @see atlib_bufread_consume
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI bufview_t atlib_bufread_peek(bufread_t * br, usize n);
+
+/**
+ * @brief Consumes @c n bytes of @c br, usually after they have been inspected with @ref atlib_bufread_peek.
+ * @param br Pointer to a valid @c bufread_t object.
+ * @param n The number of bytes to consume. At most the number of bytes currently buffered.
+ *
+ * @see atlib_bufread_peek
+ * @see atlib_bufread_skip
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI void atlib_bufread_consume(bufread_t * br, usize n);
+
+/**
+ * @brief Refills @c br, keeping its unread bytes. Internal to AtLib; the cold path of the inline readers below.
+ * @returns The number of bytes now buffered.
+ */
+extern isize __atlib_bufread_fill(bufread_t * br) __attribute__((nonnull, nothrow, cold));
+
+/* Whether values read in the stream's own byte order must be swapped on this host */
+#if ATLIB_ENDIAN == ATLIB_LITTLE_ENDIAN
+#define __atlib_bufread_swapped(br) ((br)->flags & BUFREAD_READ_BE)
+#else
+#define __atlib_bufread_swapped(br) (~(br)->flags & BUFREAD_READ_BE)
+#endif
+
+/*
+ * The fixed-width functions below are defined here, so that callers inline them, and are also
+ * exported from the library: its own translation unit defines __ATLIB_BUFREAD_INLINE_EXPORT
+ * before including this header, and so emits their out-of-line definitions.
+ */
+#ifdef __ATLIB_BUFREAD_INLINE_EXPORT
+#define __ATLIB_BUFREAD_INLINE extern
+#else
+#define __ATLIB_BUFREAD_INLINE extern inline __attribute__((gnu_inline))
+#endif
+
+/*
+ * Copies the next `n` bytes of `br` into `v`, refilling only if fewer are buffered; returns 0 at EOF.
+ * The fixed-width readers below are built on this, so each compiles down to a bounds check, one
+ * unaligned load, and at most one byte swap, with the refill kept out of line.
+ */
+__ATLIB_BUFREAD_INLINE i32 __atlib_bufread_take(bufread_t * br, void * v, usize n) {
+    if(__builtin_expect((usize)br->to_read < n, 0) && (usize)__atlib_bufread_fill(br) < n) return 0;
+    __builtin_memcpy(v, br->next, n);
+    br->next += n;
+    br->to_read -= n;
+    return 1;
+}
+
 /**
  * @brief Reads a @c u8 from @c br.
  * @param br Pointer to a valid @c bufread_t to read from.
@@ -296,7 +684,10 @@ ATAPI u32 atlib_bufread_read(bufread_t *__restrict br, void *__restrict buf, u32
  *
  * @since AtLib v1.0.0
  */
-ATAPI u8 atlib_bufread_read_u8(bufread_t * br);
+__ATLIB_BUFREAD_INLINE u8 atlib_bufread_read_u8(bufread_t * br) {
+    u8 v;
+    return __atlib_bufread_take(br, &v, sizeof(v)) ? v : 0;
+}
 
 /**
  * @brief Reads a @c u16 from @c br.
@@ -317,7 +708,11 @@ ATAPI u8 atlib_bufread_read_u8(bufread_t * br);
  *
  * @since AtLib v1.0.0
  */
-ATAPI u16 atlib_bufread_read_u16(bufread_t * br);
+__ATLIB_BUFREAD_INLINE u16 atlib_bufread_read_u16(bufread_t * br) {
+    u16 v;
+    if(!__atlib_bufread_take(br, &v, sizeof(v))) return 0;
+    return (u16)(__atlib_bufread_swapped(br) ? __builtin_bswap16(v) : v);
+}
 
 /**
  * @brief Reads a @c u16 from @c br in big-endian format.
@@ -335,7 +730,10 @@ ATAPI u16 atlib_bufread_read_u16(bufread_t * br);
  *
  * @since AtLib v1.1.0
  */
-ATAPI u16 atlib_bufread_read_u16_be(bufread_t * br);
+__ATLIB_BUFREAD_INLINE u16 atlib_bufread_read_u16_be(bufread_t * br) {
+    u16 v;
+    return __atlib_bufread_take(br, &v, sizeof(v)) ? (u16)ATLIB_BE16(v) : 0;
+}
 
 /**
  * @brief Reads a @c u16 from @c br in little-endian format.
@@ -353,7 +751,10 @@ ATAPI u16 atlib_bufread_read_u16_be(bufread_t * br);
  *
  * @since AtLib v1.1.0
  */
-ATAPI u16 atlib_bufread_read_u16_le(bufread_t * br);
+__ATLIB_BUFREAD_INLINE u16 atlib_bufread_read_u16_le(bufread_t * br) {
+    u16 v;
+    return __atlib_bufread_take(br, &v, sizeof(v)) ? (u16)ATLIB_LE16(v) : 0;
+}
 
 /**
  * @brief Reads a @c u32 from @c br.
@@ -368,7 +769,11 @@ ATAPI u16 atlib_bufread_read_u16_le(bufread_t * br);
  *
  * @since AtLib v1.0.0
  */
-ATAPI u32 atlib_bufread_read_u32(bufread_t * br);
+__ATLIB_BUFREAD_INLINE u32 atlib_bufread_read_u32(bufread_t * br) {
+    u32 v;
+    if(!__atlib_bufread_take(br, &v, sizeof(v))) return 0;
+    return (u32)(__atlib_bufread_swapped(br) ? __builtin_bswap32(v) : v);
+}
 
 /**
  * @brief Reads a @c u32 from @c br in big-endian.
@@ -383,7 +788,10 @@ ATAPI u32 atlib_bufread_read_u32(bufread_t * br);
  *
  * @since AtLib v1.1.0
  */
-ATAPI u32 atlib_bufread_read_u32_be(bufread_t * br);
+__ATLIB_BUFREAD_INLINE u32 atlib_bufread_read_u32_be(bufread_t * br) {
+    u32 v;
+    return __atlib_bufread_take(br, &v, sizeof(v)) ? (u32)ATLIB_BE32(v) : 0;
+}
 
 /**
  * @brief Reads a @c u32 from @c br in little-endian format.
@@ -398,7 +806,10 @@ ATAPI u32 atlib_bufread_read_u32_be(bufread_t * br);
  *
  * @since AtLib v1.1.0
  */
-ATAPI u32 atlib_bufread_read_u32_le(bufread_t * br);
+__ATLIB_BUFREAD_INLINE u32 atlib_bufread_read_u32_le(bufread_t * br) {
+    u32 v;
+    return __atlib_bufread_take(br, &v, sizeof(v)) ? (u32)ATLIB_LE32(v) : 0;
+}
 
 /**
  * @brief Reads a @c u64 from @c br.
@@ -413,7 +824,11 @@ ATAPI u32 atlib_bufread_read_u32_le(bufread_t * br);
  *
  * @since AtLib v1.0.0
  */
-ATAPI u64 atlib_bufread_read_u64(bufread_t * br);
+__ATLIB_BUFREAD_INLINE u64 atlib_bufread_read_u64(bufread_t * br) {
+    u64 v;
+    if(!__atlib_bufread_take(br, &v, sizeof(v))) return 0;
+    return (u64)(__atlib_bufread_swapped(br) ? __builtin_bswap64(v) : v);
+}
 
 /**
  * @brief Reads a @c u64 from @c br in big-endian format.
@@ -428,7 +843,10 @@ ATAPI u64 atlib_bufread_read_u64(bufread_t * br);
  *
  * @since AtLib v1.1.0
  */
-ATAPI u64 atlib_bufread_read_u64_be(bufread_t * br);
+__ATLIB_BUFREAD_INLINE u64 atlib_bufread_read_u64_be(bufread_t * br) {
+    u64 v;
+    return __atlib_bufread_take(br, &v, sizeof(v)) ? (u64)ATLIB_BE64(v) : 0;
+}
 
 /**
  * @brief Reads a @c u64 from @c br in little-endian format.
@@ -443,7 +861,10 @@ ATAPI u64 atlib_bufread_read_u64_be(bufread_t * br);
  *
  * @since AtLib v1.1.0
  */
-ATAPI u64 atlib_bufread_read_u64_le(bufread_t * br);
+__ATLIB_BUFREAD_INLINE u64 atlib_bufread_read_u64_le(bufread_t * br) {
+    u64 v;
+    return __atlib_bufread_take(br, &v, sizeof(v)) ? (u64)ATLIB_LE64(v) : 0;
+}
 
 /**
  * @brief Reads a @c i8 from @c br.
@@ -458,7 +879,10 @@ ATAPI u64 atlib_bufread_read_u64_le(bufread_t * br);
  *
  * @since AtLib v1.0.0
  */
-ATAPI i8 atlib_bufread_read_i8(bufread_t * br);
+__ATLIB_BUFREAD_INLINE i8 atlib_bufread_read_i8(bufread_t * br) {
+    u8 v;
+    return __atlib_bufread_take(br, &v, sizeof(v)) ? (i8)v : 0;
+}
 
 /**
  * @brief Reads a @c i16 from @c br.
@@ -473,7 +897,11 @@ ATAPI i8 atlib_bufread_read_i8(bufread_t * br);
  *
  * @since AtLib v1.0.0
  */
-ATAPI i16 atlib_bufread_read_i16(bufread_t * br);
+__ATLIB_BUFREAD_INLINE i16 atlib_bufread_read_i16(bufread_t * br) {
+    u16 v;
+    if(!__atlib_bufread_take(br, &v, sizeof(v))) return 0;
+    return (i16)(__atlib_bufread_swapped(br) ? __builtin_bswap16(v) : v);
+}
 
 /**
  * @brief Reads a @c i16 from @c br in big-endian format.
@@ -488,7 +916,10 @@ ATAPI i16 atlib_bufread_read_i16(bufread_t * br);
  *
  * @since AtLib v1.1.0
  */
-ATAPI i16 atlib_bufread_read_i16_be(bufread_t * br);
+__ATLIB_BUFREAD_INLINE i16 atlib_bufread_read_i16_be(bufread_t * br) {
+    u16 v;
+    return __atlib_bufread_take(br, &v, sizeof(v)) ? (i16)ATLIB_BE16(v) : 0;
+}
 
 /**
  * @brief Reads a @c i16 from @c br in little-endian format.
@@ -503,7 +934,10 @@ ATAPI i16 atlib_bufread_read_i16_be(bufread_t * br);
  *
  * @since AtLib v1.1.0
  */
-ATAPI i16 atlib_bufread_read_i16_le(bufread_t * br);
+__ATLIB_BUFREAD_INLINE i16 atlib_bufread_read_i16_le(bufread_t * br) {
+    u16 v;
+    return __atlib_bufread_take(br, &v, sizeof(v)) ? (i16)ATLIB_LE16(v) : 0;
+}
 
 /**
  * @brief Reads a @c i32 from @c br.
@@ -518,7 +952,11 @@ ATAPI i16 atlib_bufread_read_i16_le(bufread_t * br);
  *
  * @since AtLib v1.0.0
  */
-ATAPI i32 atlib_bufread_read_i32(bufread_t * br);
+__ATLIB_BUFREAD_INLINE i32 atlib_bufread_read_i32(bufread_t * br) {
+    u32 v;
+    if(!__atlib_bufread_take(br, &v, sizeof(v))) return 0;
+    return (i32)(__atlib_bufread_swapped(br) ? __builtin_bswap32(v) : v);
+}
 
 /**
  * @brief Reads a @c i32 from @c br in big-endian format.
@@ -533,7 +971,10 @@ ATAPI i32 atlib_bufread_read_i32(bufread_t * br);
  *
  * @since AtLib v1.1.0
  */
-ATAPI i32 atlib_bufread_read_i32_be(bufread_t * br);
+__ATLIB_BUFREAD_INLINE i32 atlib_bufread_read_i32_be(bufread_t * br) {
+    u32 v;
+    return __atlib_bufread_take(br, &v, sizeof(v)) ? (i32)ATLIB_BE32(v) : 0;
+}
 
 /**
  * @brief Reads a @c i32 from @c br in little-endian format.
@@ -548,7 +989,10 @@ ATAPI i32 atlib_bufread_read_i32_be(bufread_t * br);
  *
  * @since AtLib v1.1.0
  */
-ATAPI i32 atlib_bufread_read_i32_le(bufread_t * br);
+__ATLIB_BUFREAD_INLINE i32 atlib_bufread_read_i32_le(bufread_t * br) {
+    u32 v;
+    return __atlib_bufread_take(br, &v, sizeof(v)) ? (i32)ATLIB_LE32(v) : 0;
+}
 
 /**
  * @brief Reads a @c i54 from @c br.
@@ -563,7 +1007,11 @@ ATAPI i32 atlib_bufread_read_i32_le(bufread_t * br);
  *
  * @since AtLib v1.0.0
  */
-ATAPI i64 atlib_bufread_read_i64(bufread_t * br);
+__ATLIB_BUFREAD_INLINE i64 atlib_bufread_read_i64(bufread_t * br) {
+    u64 v;
+    if(!__atlib_bufread_take(br, &v, sizeof(v))) return 0;
+    return (i64)(__atlib_bufread_swapped(br) ? __builtin_bswap64(v) : v);
+}
 
 /**
  * @brief Reads a @c i54 from @c br in big-endian format.
@@ -578,7 +1026,10 @@ ATAPI i64 atlib_bufread_read_i64(bufread_t * br);
  *
  * @since AtLib v1.1.0
  */
-ATAPI i64 atlib_bufread_read_i64_be(bufread_t * br);
+__ATLIB_BUFREAD_INLINE i64 atlib_bufread_read_i64_be(bufread_t * br) {
+    u64 v;
+    return __atlib_bufread_take(br, &v, sizeof(v)) ? (i64)ATLIB_BE64(v) : 0;
+}
 
 /**
  * @brief Reads a @c i54 from @c br in little-endian format.
@@ -593,7 +1044,284 @@ ATAPI i64 atlib_bufread_read_i64_be(bufread_t * br);
  *
  * @since AtLib v1.1.0
  */
-ATAPI i64 atlib_bufread_read_i64_le(bufread_t * br);
+__ATLIB_BUFREAD_INLINE i64 atlib_bufread_read_i64_le(bufread_t * br) {
+    u64 v;
+    return __atlib_bufread_take(br, &v, sizeof(v)) ? (i64)ATLIB_LE64(v) : 0;
+}
+
+/**
+ * @brief Reads @c n values of type @c u16 from @c br into @c dst, in the endianness the stream was opened with.
+ * @param br Pointer to a valid @c bufread_t to read from.
+ * @param dst Pointer to an array of at least @c n values.
+ * @param n Number of values to read.
+ * @returns Number of values read. If less than @c n, then @c EOF has been encountered.
+ *
+ * The values are copied out of the buffer in one pass: a plain @c memcpy when the stream
+ * matches the host's endianness, and a SIMD byte swap otherwise. Use this instead of calling
+ * @ref atlib_bufread_read_u16 in a loop.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufread_read_u16_array(bufread_t *__restrict br, u16 *__restrict dst, usize n);
+
+/**
+ * @brief Reads @c n values of type @c u16 from @c br into @c dst, in big-endian format.
+ * @param br Pointer to a valid @c bufread_t to read from.
+ * @param dst Pointer to an array of at least @c n values.
+ * @param n Number of values to read.
+ * @returns Number of values read. If less than @c n, then @c EOF has been encountered.
+ *
+ * The values are copied out of the buffer in one pass: a plain @c memcpy when the stream
+ * matches the host's endianness, and a SIMD byte swap otherwise. Use this instead of calling
+ * @ref atlib_bufread_read_u16_be in a loop.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufread_read_u16_array_be(bufread_t *__restrict br, u16 *__restrict dst, usize n);
+
+/**
+ * @brief Reads @c n values of type @c u16 from @c br into @c dst, in little-endian format.
+ * @param br Pointer to a valid @c bufread_t to read from.
+ * @param dst Pointer to an array of at least @c n values.
+ * @param n Number of values to read.
+ * @returns Number of values read. If less than @c n, then @c EOF has been encountered.
+ *
+ * The values are copied out of the buffer in one pass: a plain @c memcpy when the stream
+ * matches the host's endianness, and a SIMD byte swap otherwise. Use this instead of calling
+ * @ref atlib_bufread_read_u16_le in a loop.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufread_read_u16_array_le(bufread_t *__restrict br, u16 *__restrict dst, usize n);
+
+/**
+ * @brief Reads @c n values of type @c u32 from @c br into @c dst, in the endianness the stream was opened with.
+ * @param br Pointer to a valid @c bufread_t to read from.
+ * @param dst Pointer to an array of at least @c n values.
+ * @param n Number of values to read.
+ * @returns Number of values read. If less than @c n, then @c EOF has been encountered.
+ *
+ * The values are copied out of the buffer in one pass: a plain @c memcpy when the stream
+ * matches the host's endianness, and a SIMD byte swap otherwise. Use this instead of calling
+ * @ref atlib_bufread_read_u32 in a loop.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufread_read_u32_array(bufread_t *__restrict br, u32 *__restrict dst, usize n);
+
+/**
+ * @brief Reads @c n values of type @c u32 from @c br into @c dst, in big-endian format.
+ * @param br Pointer to a valid @c bufread_t to read from.
+ * @param dst Pointer to an array of at least @c n values.
+ * @param n Number of values to read.
+ * @returns Number of values read. If less than @c n, then @c EOF has been encountered.
+ *
+ * The values are copied out of the buffer in one pass: a plain @c memcpy when the stream
+ * matches the host's endianness, and a SIMD byte swap otherwise. Use this instead of calling
+ * @ref atlib_bufread_read_u32_be in a loop.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufread_read_u32_array_be(bufread_t *__restrict br, u32 *__restrict dst, usize n);
+
+/**
+ * @brief Reads @c n values of type @c u32 from @c br into @c dst, in little-endian format.
+ * @param br Pointer to a valid @c bufread_t to read from.
+ * @param dst Pointer to an array of at least @c n values.
+ * @param n Number of values to read.
+ * @returns Number of values read. If less than @c n, then @c EOF has been encountered.
+ *
+ * The values are copied out of the buffer in one pass: a plain @c memcpy when the stream
+ * matches the host's endianness, and a SIMD byte swap otherwise. Use this instead of calling
+ * @ref atlib_bufread_read_u32_le in a loop.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufread_read_u32_array_le(bufread_t *__restrict br, u32 *__restrict dst, usize n);
+
+/**
+ * @brief Reads @c n values of type @c u64 from @c br into @c dst, in the endianness the stream was opened with.
+ * @param br Pointer to a valid @c bufread_t to read from.
+ * @param dst Pointer to an array of at least @c n values.
+ * @param n Number of values to read.
+ * @returns Number of values read. If less than @c n, then @c EOF has been encountered.
+ *
+ * The values are copied out of the buffer in one pass: a plain @c memcpy when the stream
+ * matches the host's endianness, and a SIMD byte swap otherwise. Use this instead of calling
+ * @ref atlib_bufread_read_u64 in a loop.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufread_read_u64_array(bufread_t *__restrict br, u64 *__restrict dst, usize n);
+
+/**
+ * @brief Reads @c n values of type @c u64 from @c br into @c dst, in big-endian format.
+ * @param br Pointer to a valid @c bufread_t to read from.
+ * @param dst Pointer to an array of at least @c n values.
+ * @param n Number of values to read.
+ * @returns Number of values read. If less than @c n, then @c EOF has been encountered.
+ *
+ * The values are copied out of the buffer in one pass: a plain @c memcpy when the stream
+ * matches the host's endianness, and a SIMD byte swap otherwise. Use this instead of calling
+ * @ref atlib_bufread_read_u64_be in a loop.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufread_read_u64_array_be(bufread_t *__restrict br, u64 *__restrict dst, usize n);
+
+/**
+ * @brief Reads @c n values of type @c u64 from @c br into @c dst, in little-endian format.
+ * @param br Pointer to a valid @c bufread_t to read from.
+ * @param dst Pointer to an array of at least @c n values.
+ * @param n Number of values to read.
+ * @returns Number of values read. If less than @c n, then @c EOF has been encountered.
+ *
+ * The values are copied out of the buffer in one pass: a plain @c memcpy when the stream
+ * matches the host's endianness, and a SIMD byte swap otherwise. Use this instead of calling
+ * @ref atlib_bufread_read_u64_le in a loop.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufread_read_u64_array_le(bufread_t *__restrict br, u64 *__restrict dst, usize n);
+
+/**
+ * @brief Reads @c n values of type @c f32 from @c br into @c dst, in the endianness the stream was opened with.
+ * @param br Pointer to a valid @c bufread_t to read from.
+ * @param dst Pointer to an array of at least @c n values.
+ * @param n Number of values to read.
+ * @returns Number of values read. If less than @c n, then @c EOF has been encountered.
+ *
+ * The values are copied out of the buffer in one pass: a plain @c memcpy when the stream
+ * matches the host's endianness, and a SIMD byte swap otherwise.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufread_read_f32_array(bufread_t *__restrict br, f32 *__restrict dst, usize n);
+
+/**
+ * @brief Reads @c n values of type @c f32 from @c br into @c dst, in big-endian format.
+ * @param br Pointer to a valid @c bufread_t to read from.
+ * @param dst Pointer to an array of at least @c n values.
+ * @param n Number of values to read.
+ * @returns Number of values read. If less than @c n, then @c EOF has been encountered.
+ *
+ * The values are copied out of the buffer in one pass: a plain @c memcpy when the stream
+ * matches the host's endianness, and a SIMD byte swap otherwise.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufread_read_f32_array_be(bufread_t *__restrict br, f32 *__restrict dst, usize n);
+
+/**
+ * @brief Reads @c n values of type @c f32 from @c br into @c dst, in little-endian format.
+ * @param br Pointer to a valid @c bufread_t to read from.
+ * @param dst Pointer to an array of at least @c n values.
+ * @param n Number of values to read.
+ * @returns Number of values read. If less than @c n, then @c EOF has been encountered.
+ *
+ * The values are copied out of the buffer in one pass: a plain @c memcpy when the stream
+ * matches the host's endianness, and a SIMD byte swap otherwise.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufread_read_f32_array_le(bufread_t *__restrict br, f32 *__restrict dst, usize n);
+
+/**
+ * @brief Reads @c n values of type @c f64 from @c br into @c dst, in the endianness the stream was opened with.
+ * @param br Pointer to a valid @c bufread_t to read from.
+ * @param dst Pointer to an array of at least @c n values.
+ * @param n Number of values to read.
+ * @returns Number of values read. If less than @c n, then @c EOF has been encountered.
+ *
+ * The values are copied out of the buffer in one pass: a plain @c memcpy when the stream
+ * matches the host's endianness, and a SIMD byte swap otherwise.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufread_read_f64_array(bufread_t *__restrict br, f64 *__restrict dst, usize n);
+
+/**
+ * @brief Reads @c n values of type @c f64 from @c br into @c dst, in big-endian format.
+ * @param br Pointer to a valid @c bufread_t to read from.
+ * @param dst Pointer to an array of at least @c n values.
+ * @param n Number of values to read.
+ * @returns Number of values read. If less than @c n, then @c EOF has been encountered.
+ *
+ * The values are copied out of the buffer in one pass: a plain @c memcpy when the stream
+ * matches the host's endianness, and a SIMD byte swap otherwise.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufread_read_f64_array_be(bufread_t *__restrict br, f64 *__restrict dst, usize n);
+
+/**
+ * @brief Reads @c n values of type @c f64 from @c br into @c dst, in little-endian format.
+ * @param br Pointer to a valid @c bufread_t to read from.
+ * @param dst Pointer to an array of at least @c n values.
+ * @param n Number of values to read.
+ * @returns Number of values read. If less than @c n, then @c EOF has been encountered.
+ *
+ * The values are copied out of the buffer in one pass: a plain @c memcpy when the stream
+ * matches the host's endianness, and a SIMD byte swap otherwise.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufread_read_f64_array_le(bufread_t *__restrict br, f64 *__restrict dst, usize n);
+
+/**
+ * @brief Reads an unsigned LEB128 varint from @c br.
+ * @param br Pointer to a valid @c bufread_t object to read from.
+ * @returns The decoded value, or 0 if @c br has no more data or the varint is cut short by the end of the stream.
+ *
+ * When at least 10 bytes are buffered, which is the longest a varint can be, the varint is
+ * decoded from a single unaligned 8-byte load. Its end is found from the high bits of all
+ * eight bytes at once, and the 7-bit groups are packed together in three mask-and-shift steps,
+ * with no branch per byte. Otherwise it is decoded a byte at a time across refills.
+ *
+ * At most 10 bytes are consumed; any bits beyond 64 are dropped.
+ *
+ * @see atlib_bufwrite_write_uvarint
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI u64 atlib_bufread_read_uvarint(bufread_t * br);
+
+/**
+ * @brief Reads a zigzag-encoded LEB128 varint from @c br.
+ * @param br Pointer to a valid @c bufread_t object to read from.
+ * @returns The decoded value, or 0 if @c br has no more data.
+ *
+ * @see atlib_bufread_read_uvarint
+ * @see atlib_bufwrite_write_svarint
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI i64 atlib_bufread_read_svarint(bufread_t * br);
+
+/**
+ * @brief Reads up to @c n unsigned LEB128 varints from @c br into @c dst.
+ * @param br Pointer to a valid @c bufread_t object to read from.
+ * @param dst Array of at least @c n values to fill.
+ * @returns The number of varints read, which is less than @c n only at the end of the stream.
+ *
+ * Decodes with the same fast path as @ref atlib_bufread_read_uvarint, without a function call
+ * or a refill check per value, for as long as a whole varint is sure to be buffered.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufread_read_uvarint_array(bufread_t *__restrict br, u64 *__restrict dst, usize n);
+
+/**
+ * @brief Reads up to @c n zigzag-encoded LEB128 varints from @c br into @c dst.
+ * @param br Pointer to a valid @c bufread_t object to read from.
+ * @param dst Array of at least @c n values to fill.
+ * @returns The number of varints read, which is less than @c n only at the end of the stream.
+ *
+ * @see atlib_bufread_read_uvarint_array
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufread_read_svarint_array(bufread_t *__restrict br, i64 *__restrict dst, usize n);
 
 /**
  * @brief Skips @c n bytes in the stream, effectively throwing them away.
@@ -602,6 +1330,7 @@ ATAPI i64 atlib_bufread_read_i64_le(bufread_t * br);
  * 
  * If the skip is large enough, a buffer refresh will be required.
  * If skipping too far, @c br will encounter @c EOF.
+ * A negative @c n skips backwards, stopping at the start of the stream.
  *
  * @see atlib_bufread_rewind
  * @see atlib_bufread_seek
@@ -642,9 +1371,12 @@ ATAPI void atlib_bufread_seek(bufread_t * br, usize n);
 /**
  * @brief Provides the position @c br is in its file/media.
  * @param br Pointer to a valid @c bufread_t.
+ *
+ * The position is tracked by @c br itself, so this never calls into the underlying file.
+ *
  * @since AtLib v1.0.0
  */
-static inline usize atlib_bufread_pos(const bufread_t * br) { return ftell(br->fh) - br->to_read; }
+static inline usize atlib_bufread_pos(const bufread_t * br) { return br->off - br->to_read; }
 
 /**
  * @brief Provides the position @c br is in its file/media, without compensating for the buffer.
@@ -652,7 +1384,7 @@ static inline usize atlib_bufread_pos(const bufread_t * br) { return ftell(br->f
  * @returns Position the file is at, without compensating for what has been read in the current file.
  * @since AtLib v1.0.0
  */
-static inline usize atlib_bufread_fpos(const bufread_t * br) { return ftell(br->fh); }
+static inline usize atlib_bufread_fpos(const bufread_t * br) { return br->off; }
 
 /**
  * @brief Provides if @c br has encountered an error, and cannot continue to read.
@@ -660,7 +1392,7 @@ static inline usize atlib_bufread_fpos(const bufread_t * br) { return ftell(br->
  * @returns Non-zero if the underlying file/media has encountered an error.
  * @since AtLib v1.0.0
  */
-static inline usize atlib_bufread_err(const bufread_t * br) { return ferror(br->fh); }
+static inline usize atlib_bufread_err(const bufread_t * br) { return br->flags & BUFREAD_ERR; }
 
 /**
  * @brief Provides if @c br has encountered EOF, and cannot continue to read.
@@ -668,6 +1400,6 @@ static inline usize atlib_bufread_err(const bufread_t * br) { return ferror(br->
  * @returns Non-zero if the underlying file/media has encountered EOF.
  * @since AtLib v1.0.0
  */
-static inline usize atlib_bufread_eof(const bufread_t * br) { return feof(br->fh); }
+static inline usize atlib_bufread_eof(const bufread_t * br) { return br->flags & BUFREAD_EOF; }
 
 #endif /* __ATLIB_BUFREAD_H */
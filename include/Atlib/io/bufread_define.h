@@ -0,0 +1,97 @@
+#ifndef __ATLIB_BUFREAD_DEFINE_H
+#define __ATLIB_BUFREAD_DEFINE_H
+
+/**
+ * @file bufread_define.h
+ * @brief Generates reader types whose byte order and buffer capacity are fixed at compile time.
+ */
+
+#include "Atlib/types.h"
+#include "Atlib/io/endian.h"
+#include "Atlib/io/bufread.h"
+
+/**
+ * @def ATLIB_DEFINE_BUFREAD(name, size, endian)
+ * @brief Defines the reader type @c name_t, with a buffer of @c size bytes, reading @c endian values.
+ * @param name The prefix of the generated type and functions.
+ * @param size The capacity of the buffer embedded in @c name_t, in bytes. Must be non-zero.
+ * @param endian The byte order of every multi-byte value, either @c BE or @c LE.
+ *
+ * The generated @c name_t wraps a @c bufread_t, @c br, together with a buffer of its own,
+ * and comes with these static inline functions:
+ *
+ * - @c name_open(r, file_path, br_flags) and @c name_close(r), as @ref atlib_bufread_open and
+ *   @ref atlib_bufread_close. @c br_flags may hold any flag, except that its byte order is
+ *   replaced by @c endian.
+ * - @c name_read_u8 through @c name_read_u64 and @c name_read_i8 through @c name_read_i64,
+ *   as @ref atlib_bufread_read_u8 and its siblings.
+ *
+ * The byte order is part of each function, so the readers never test @c BUFREAD_READ_BE
+ * and compile down to a bounds check, one unaligned load, and at most one byte swap. Any
+ * other function of @c bufread_t can be used on @c &r->br.
+ *
+ * Each format can so get the buffer that suits it, instead of one global
+ * @ref __ATLIB_BUFREAD_SIZE, and any number of specializations may live side by side.
+ *
+ * Example:
+ * @code{.c}
+ * ATLIB_DEFINE_BUFREAD(pcap, 1 << 16, LE)
+ * ATLIB_DEFINE_BUFREAD(netbuf, 1 << 12, BE)
+ *
+ * pcap_t r;
+ * if(pcap_open(&r, "trace.pcap", BUFREAD_FD) == nullptr) { /\* Handle Error Here *\/ }
+ * const u32 magic = pcap_read_u32(&r);
+ * const u16 major = pcap_read_u16(&r);
+ * pcap_close(&r);
+ * @endcode
+ *
+ * @warning A @c name_t must not be copied or moved once opened, since its @c br points into it.
+ *
+ * @since AtLib v1.1.0
+ */
+#define ATLIB_DEFINE_BUFREAD(name, size, endian)                                                            \
+    typedef struct {                                                                                        \
+        bufread_t br;                                                                                       \
+        char mem[size];                                                                                     \
+    } name##_t;                                                                                             \
+                                                                                                            \
+    static inline name##_t * name##_open(name##_t * r, const char * file_path, u32 br_flags) {              \
+        br_flags = (br_flags & ~(BUFREAD_READ_BE | BUFREAD_READ_LE)) | BUFREAD_READ_##endian;               \
+        if(atlib_bufread_open(&r->br, file_path, br_flags) == NULL) return NULL;                           \
+        if(atlib_bufread_setbuf(&r->br, r->mem, sizeof(r->mem)) == NULL) {                                  \
+            atlib_bufread_close(&r->br);                                                                    \
+            return NULL;                                                                                    \
+        }                                                                                                   \
+        return r;                                                                                           \
+    }                                                                                                       \
+                                                                                                            \
+    static inline void name##_close(name##_t * r) {                                                         \
+        atlib_bufread_close(&r->br);                                                                        \
+    }                                                                                                       \
+                                                                                                            \
+    static inline u8 name##_read_u8(name##_t * r) {                                                         \
+        u8 v;                                                                                               \
+        return __atlib_bufread_take(&r->br, &v, sizeof(v)) ? v : 0;                                         \
+    }                                                                                                       \
+                                                                                                            \
+    static inline u16 name##_read_u16(name##_t * r) {                                                       \
+        u16 v;                                                                                              \
+        return __atlib_bufread_take(&r->br, &v, sizeof(v)) ? (u16)ATLIB_##endian##16(v) : 0;                \
+    }                                                                                                       \
+                                                                                                            \
+    static inline u32 name##_read_u32(name##_t * r) {                                                       \
+        u32 v;                                                                                              \
+        return __atlib_bufread_take(&r->br, &v, sizeof(v)) ? (u32)ATLIB_##endian##32(v) : 0;                \
+    }                                                                                                       \
+                                                                                                            \
+    static inline u64 name##_read_u64(name##_t * r) {                                                       \
+        u64 v;                                                                                              \
+        return __atlib_bufread_take(&r->br, &v, sizeof(v)) ? (u64)ATLIB_##endian##64(v) : 0;                \
+    }                                                                                                       \
+                                                                                                            \
+    static inline i8 name##_read_i8(name##_t * r) { return (i8)name##_read_u8(r); }                         \
+    static inline i16 name##_read_i16(name##_t * r) { return (i16)name##_read_u16(r); }                     \
+    static inline i32 name##_read_i32(name##_t * r) { return (i32)name##_read_u32(r); }                     \
+    static inline i64 name##_read_i64(name##_t * r) { return (i64)name##_read_u64(r); }
+
+#endif
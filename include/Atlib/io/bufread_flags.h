@@ -28,6 +28,101 @@
  */
 #define BUFREAD_READ_LE         ((u32)(1 << 2))
 
+/**
+ * @def BUFREAD_MMAP
+ * @brief Signals that this stream should map the whole file into memory and
+ * serve every read straight from the mapping, instead of copying it through
+ * the internal buffer.
+ *
+ * Unless other hints are given, the mapping is advised as @ref BUFREAD_SEQUENTIAL
+ * and @ref BUFREAD_WILLNEED.
+ *
+ * Only regular, non-empty files can be mapped. If the file cannot be mapped,
+ * the flag is cleared and the stream falls back to regular buffered reading.
+ */
+#define BUFREAD_MMAP            ((u32)(1 << 3))
+
+/**
+ * @def BUFREAD_FD
+ * @brief Signals that this stream reads from a raw file descriptor with @c read(2),
+ * bypassing stdio and its internal buffer entirely.
+ */
+#define BUFREAD_FD              ((u32)(1 << 4))
+
+/**
+ * @def BUFREAD_BUF_ALLOC
+ * @brief Set by AtLib when the stream's buffer was allocated by AtLib (see @ref atlib_bufread_setbuf),
+ * and must be freed when the stream is closed.
+ */
+#define BUFREAD_BUF_ALLOC       ((u32)(1 << 5))
+
+/**
+ * @def BUFREAD_READAHEAD
+ * @brief Signals that this stream should read ahead on a background thread,
+ * filling a second buffer while the current one is being consumed.
+ *
+ * The helper thread is started on the first refill. If it cannot be started,
+ * or the buffer is too small to split reads across, the flag is cleared and the stream falls back to regular buffered reading.
+ * Has no effect together with @ref BUFREAD_MMAP.
+ */
+#define BUFREAD_READAHEAD       ((u32)(1 << 6))
+
+/**
+ * @def BUFREAD_SEQUENTIAL
+ * @brief Hints that this stream will be read front to back, so the kernel
+ * can read further ahead of it (@c POSIX_FADV_SEQUENTIAL, or @c MADV_SEQUENTIAL
+ * when mapped).
+ */
+#define BUFREAD_SEQUENTIAL      ((u32)(1 << 7))
+
+/**
+ * @def BUFREAD_RANDOM
+ * @brief Hints that this stream will seek around, so the kernel should not
+ * read ahead of it (@c POSIX_FADV_RANDOM, or @c MADV_RANDOM when mapped).
+ * Takes precedence over @ref BUFREAD_SEQUENTIAL.
+ */
+#define BUFREAD_RANDOM          ((u32)(1 << 8))
+
+/**
+ * @def BUFREAD_NOREUSE
+ * @brief Hints that the data of this stream will be read only once, so it should
+ * not stay in the page cache at the expense of other processes.
+ *
+ * Besides @c POSIX_FADV_NOREUSE, the stream releases the pages behind it with
+ * @c POSIX_FADV_DONTNEED as it goes, in steps of 1 MiB, and on close. Pages
+ * shared with other readers of the file are released as well. Ignored for
+ * the pages of a mapped file.
+ */
+#define BUFREAD_NOREUSE         ((u32)(1 << 9))
+
+/**
+ * @def BUFREAD_WILLNEED
+ * @brief Hints that the whole stream will be needed soon, so the kernel
+ * should start reading it into the page cache right away (@c readahead(2),
+ * or @c MADV_WILLNEED when mapped). Ranged streams only prefetch their range.
+ */
+#define BUFREAD_WILLNEED        ((u32)(1 << 10))
+
+/**
+ * @def BUFREAD_MEM
+ * @brief Set by AtLib when the stream reads from a region of memory (see @ref atlib_bufread_memopen),
+ * which is served in place, just as a mapped file is.
+ */
+#define BUFREAD_MEM             ((u32)(1 << 11))
+
+/**
+ * @def BUFREAD_EOF
+ * @brief Set by AtLib once the stream has encountered the end of its file.
+ * Cleared when the stream is moved outside of its buffer.
+ */
+#define BUFREAD_EOF             ((u32)(1 << 30))
+
+/**
+ * @def BUFREAD_ERR
+ * @brief Set by AtLib once the stream has encountered an error, and cannot continue to read.
+ */
+#define BUFREAD_ERR             ((u32)1 << 31)
+
 /**
  * @def BUFREAD_READ_NATIVE
  * @brief Signals that this stream will interpret all multi-byte structures,
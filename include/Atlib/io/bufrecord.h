@@ -0,0 +1,223 @@
+#ifndef __ATLIB_BUFRECORD_H
+#define __ATLIB_BUFRECORD_H
+
+/**
+ * @file bufrecord.h
+ * @brief Decodes and encodes fixed-size binary records in batches, from a layout described once.
+ */
+
+#include <stddef.h>
+
+#include "Atlib/types.h"
+#include "Atlib/io/bufread.h"
+#include "Atlib/io/bufwrite.h"
+
+/**
+ * @def BUFRECORD_U8
+ * @brief A field holding an unsigned 8-bit integer.
+ */
+#define BUFRECORD_U8        ((u32)(0x01))
+
+/**
+ * @def BUFRECORD_U16
+ * @brief A field holding an unsigned 16-bit integer.
+ */
+#define BUFRECORD_U16       ((u32)(0x02))
+
+/**
+ * @def BUFRECORD_U32
+ * @brief A field holding an unsigned 32-bit integer.
+ */
+#define BUFRECORD_U32       ((u32)(0x04))
+
+/**
+ * @def BUFRECORD_U64
+ * @brief A field holding an unsigned 64-bit integer.
+ */
+#define BUFRECORD_U64       ((u32)(0x08))
+
+/**
+ * @def BUFRECORD_I8
+ * @brief A field holding a signed 8-bit integer.
+ */
+#define BUFRECORD_I8        ((u32)(0x11))
+
+/**
+ * @def BUFRECORD_I16
+ * @brief A field holding a signed 16-bit integer.
+ */
+#define BUFRECORD_I16       ((u32)(0x12))
+
+/**
+ * @def BUFRECORD_I32
+ * @brief A field holding a signed 32-bit integer.
+ */
+#define BUFRECORD_I32       ((u32)(0x14))
+
+/**
+ * @def BUFRECORD_I64
+ * @brief A field holding a signed 64-bit integer.
+ */
+#define BUFRECORD_I64       ((u32)(0x18))
+
+/**
+ * @def BUFRECORD_F32
+ * @brief A field holding an IEEE 754 single precision float.
+ */
+#define BUFRECORD_F32       ((u32)(0x24))
+
+/**
+ * @def BUFRECORD_F64
+ * @brief A field holding an IEEE 754 double precision float.
+ */
+#define BUFRECORD_F64       ((u32)(0x28))
+
+/**
+ * @def BUFRECORD_BYTES
+ * @brief A field of raw bytes, copied as they are, i.e. a @c char[] member. Its width is the size of the member.
+ *
+ * The low four bits of every other type are its width, in bytes.
+ */
+#define BUFRECORD_BYTES     ((u32)(0x30))
+
+/**
+ * @def BUFRECORD_NATIVE
+ * @brief A field stored in the byte order of the host.
+ */
+#define BUFRECORD_NATIVE    ((u32)(0))
+
+/**
+ * @def BUFRECORD_BE
+ * @brief A field stored in big-endian format.
+ */
+#define BUFRECORD_BE        ((u32)(1))
+
+/**
+ * @def BUFRECORD_LE
+ * @brief A field stored in little-endian format.
+ */
+#define BUFRECORD_LE        ((u32)(2))
+
+/**
+ * @brief One field of a binary record, and the struct member it is decoded into.
+ *
+ * Usually built with @ref BUFRECORD_FIELD.
+ */
+typedef struct {
+    u32 type;                       ///< @brief One of the @c BUFRECORD_U8 ... @c BUFRECORD_BYTES types.
+    u32 order;                      ///< @brief @ref BUFRECORD_BE, @ref BUFRECORD_LE, or @ref BUFRECORD_NATIVE.
+    usize off;                      ///< @brief The offset of the field within the record, in bytes.
+    usize dst;                      ///< @brief The offset of the member within the struct, in bytes.
+    usize len;                      ///< @brief The size of the member, in bytes.
+} bufrecord_field_t;
+
+/**
+ * @def BUFRECORD_FIELD(type, order, off, st, member)
+ * @brief Describes the field of @c type and @c order at offset @c off of a record, decoded into @c st.member.
+ */
+#define BUFRECORD_FIELD(type, order, off, st, member) \
+    ((bufrecord_field_t){ (type), (order), (off), offsetof(st, member), sizeof(((st *)0)->member) })
+
+/**
+ * @brief A record layout, compiled into a plan to decode and encode batches of records.
+ *
+ * Adjacent fields that need no byte swap, and are laid out the same way in the record and
+ * in the struct, are merged into a single copy. Each step then runs over a whole chunk of
+ * records before the next one, so that it compiles down to a tight loop of loads, swaps,
+ * and stores. When the record and the struct both fit in 16 bytes, and SSSE3 is available,
+ * the whole record is instead moved into place, and every field swapped, with one byte
+ * shuffle.
+ *
+ * @see atlib_bufrecord_compile
+ * @see atlib_bufrecord_free
+ */
+typedef struct {
+    usize size;                     ///< @brief The size of a record, in bytes.
+    usize stride;                   ///< @brief The size of a struct, in bytes.
+    usize nops;                     ///< @brief The number of steps in @c ops.
+    struct __bufrecord_op * ops;    ///< @brief The steps decoding one record.
+    i32 covered;                    ///< @brief Whether the fields cover every byte of a record.
+    i32 shuffle;                    ///< @brief 1 if records are moved with one byte shuffle, 2 if it also fills the whole struct, 0 otherwise.
+    u8 dec[16];                     ///< @brief The shuffle moving a record into a struct.
+    u8 enc[16];                     ///< @brief The shuffle moving a struct into a record.
+    u8 keep[16];                    ///< @brief The bytes of a struct not touched by any field.
+} bufrecord_t;
+
+/**
+ * @brief Compiles the @c n @c fields of a record into @c plan.
+ * @param plan Pointer to a @c bufrecord_t object.
+ * @param fields The fields of the record, in any order.
+ * @param n The number of fields.
+ * @param size The size of a record, in bytes. Bytes not covered by any field are skipped
+ * when decoding, and written as zeros when encoding.
+ * @param stride The size of the struct each record is decoded into, i.e. @c sizeof(st).
+ * Members not covered by any field are left untouched when decoding.
+ * @returns Pointer to @c plan on success, or @c nullptr if a field overlaps another, does
+ * not fit in the record or the struct, its width differs from its member's, or memory
+ * could not be allocated.
+ *
+ * Example:
+ * @code{.c}
+ * typedef struct { u32 id; i16 temp; u8 flags; f64 price; } tick_t;
+ *
+ * const bufrecord_field_t fields[] = {
+ *     BUFRECORD_FIELD(BUFRECORD_U32, BUFRECORD_LE, 0, tick_t, id),
+ *     BUFRECORD_FIELD(BUFRECORD_I16, BUFRECORD_BE, 4, tick_t, temp),
+ *     BUFRECORD_FIELD(BUFRECORD_U8, BUFRECORD_NATIVE, 6, tick_t, flags),
+ *     BUFRECORD_FIELD(BUFRECORD_F64, BUFRECORD_LE, 8, tick_t, price),
+ * };
+ *
+ * bufrecord_t plan;
+ * tick_t ticks[1024];
+ * if(atlib_bufrecord_compile(&plan, fields, 4, 16, sizeof(tick_t)) == nullptr) { /\* Handle Error Here *\/ }
+ *
+ * usize n;
+ * while((n = atlib_bufrecord_decode(&plan, br, ticks, 1024)) > 0) {
+ *     /\* Use ticks[0] ... ticks[n - 1] *\/
+ * }
+ * atlib_bufrecord_free(&plan);
+ * @endcode
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI bufrecord_t * atlib_bufrecord_compile(bufrecord_t *__restrict plan, const bufrecord_field_t *__restrict fields, usize n, usize size, usize stride);
+
+/**
+ * @brief Releases @c plan.
+ * @param plan Pointer to a valid @c bufrecord_t object.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI void atlib_bufrecord_free(bufrecord_t * plan);
+
+/**
+ * @brief Decodes at most @c n records from @c br into the struct array @c dst.
+ * @param plan Pointer to a valid @c bufrecord_t object.
+ * @param br Pointer to a valid @c bufread_t object.
+ * @param dst Array of at least @c n structs.
+ * @returns The number of records decoded. Fewer than @c n are decoded only at the end of the
+ * stream, where a trailing partial record is left unread.
+ *
+ * Records are decoded in place, straight out of the buffer of @c br, as many at a time as
+ * it holds, so there is no function call and no bounds check per field. The byte order of
+ * @c br is ignored; each field has its own.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufrecord_decode(const bufrecord_t *__restrict plan, bufread_t *__restrict br, void *__restrict dst, usize n);
+
+/**
+ * @brief Encodes the @c n structs of @c src as records into @c bw.
+ * @param plan Pointer to a valid @c bufrecord_t object.
+ * @param bw Pointer to a valid @c bufwrite_t object.
+ * @param src Array of @c n structs.
+ * @returns The number of records encoded, which is less than @c n only if an error occured.
+ *
+ * The mirror of @ref atlib_bufrecord_decode. Records are encoded straight into the buffer
+ * of @c bw, as many at a time as fit.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI usize atlib_bufrecord_encode(const bufrecord_t *__restrict plan, bufwrite_t *__restrict bw, const void *__restrict src, usize n);
+
+#endif
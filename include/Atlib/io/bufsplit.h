@@ -0,0 +1,78 @@
+#ifndef __ATLIB_BUFSPLIT_H
+#define __ATLIB_BUFSPLIT_H
+
+/**
+ * @file bufsplit.h
+ * @brief Splits a file into record-aligned ranges, and fans them out to worker threads.
+ */
+
+#include "Atlib/types.h"
+#include "Atlib/io/bufread.h"
+
+/**
+ * @brief A function that processes one range of a file.
+ * @param br A ranged stream over the worker's share of the file, opened and closed by AtLib.
+ * @param idx The index of the range, from 0, in file order.
+ * @param arg The argument given to @ref atlib_bufread_parallel.
+ * @returns 0 on success, or any other value to report an error.
+ */
+typedef i32 (*bufread_worker_t)(bufread_t * br, usize idx, void * arg);
+
+/**
+ * @brief Splits @c file_path into at most @c n ranges that start and end on record boundaries.
+ * @param file_path The path of the file to split.
+ * @param delim The delimiter ending each record, i.e. @c "\n".
+ * @param dlen The length of @c delim, in bytes. Must be non-zero.
+ * @param ranges Array of at least @c n ranges to fill in.
+ * @param n The maximum number of ranges.
+ * @returns The number of ranges written to @c ranges, or -1 if @c file_path could not be read.
+ *
+ * The file is cut into @c n roughly equal parts, and each cut is moved forward to just
+ * after the next @c delim, so that no record is split between two ranges. Small files,
+ * or files with very long records, may produce fewer than @c n ranges. An empty file
+ * produces none.
+ *
+ * Only the bytes around each cut are read, not the whole file.
+ *
+ * @warning A delimiter that can overlap itself (i.e. @c "aa") may be matched at the
+ * wrong offset when a cut lands inside a run of it.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI isize atlib_bufread_split(const char *__restrict file_path, const char *__restrict delim, usize dlen, bufrange_t *__restrict ranges, usize n);
+
+/**
+ * @brief Processes @c file_path on @c n threads, each owning one record-aligned range.
+ * @param file_path The path of the file to process.
+ * @param delim The delimiter ending each record, i.e. @c "\n".
+ * @param dlen The length of @c delim, in bytes. Must be non-zero.
+ * @param n The number of threads, or 0 for one per online CPU.
+ * @param br_flags Flags for each ranged stream. See @see bufread_flags.h for more information.
+ * @param fn The function run on each range.
+ * @param arg An argument passed to every call of @c fn. May be @c nullptr.
+ * @returns 0 once every range has been processed successfully, the first non-zero value
+ * returned by @c fn, in range order, or -1 if the file or a range could not be opened.
+ *
+ * The file is split with @ref atlib_bufread_split. Each range is opened as its own stream
+ * with @ref atlib_bufread_open_range, and handed to @c fn on its own thread. The calling
+ * thread processes the first range itself, and returns once all threads are done.
+ *
+ * Example:
+ * @code{.c}
+ * static i32 count(bufread_t * br, usize idx, void * arg) {
+ *     usize * lines = arg;
+ *     bufview_t line;
+ *     while(atlib_bufread_next_line(br, &line)) lines[idx]++;
+ *     return 0;
+ * }
+ *
+ * usize lines[8] = { 0 };
+ * atlib_bufread_parallel("big.log", "\n", 1, 8, BUFREAD_FD, count, lines);
+ * @endcode
+ *
+ * @since AtLib v1.1.0
+ */
+extern i32 atlib_bufread_parallel(const char *__restrict file_path, const char *__restrict delim, usize dlen, usize n, u32 br_flags, bufread_worker_t fn, void * arg)
+    __attribute__((nonnull(1, 2, 6)));
+
+#endif
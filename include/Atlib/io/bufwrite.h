@@ -2,8 +2,12 @@
 #define __ATLIB_BUFWRITE_H
 
 #include "Atlib/types.h"
+#include "Atlib/io/bufwrite_flags.h"
+#include "Atlib/io/endian.h"
+#include "Atlib/io/uring.h"
 #include <bits/types/FILE.h>
 #include <stdio.h>
+#include <sys/uio.h>
 
 typedef __builtin_va_list va_list;
 
@@ -20,7 +24,14 @@ typedef __builtin_va_list va_list;
  * as an intermediate buffer between a user and a file.
  * The internal buffer's size is controlled by the macro __ATLIB_BUFWRITE_SIZE,
  * which defaults to '4096'. To act as an unbuffered writer, define this value
- * to '1'.
+ * to '1'. A single stream can use a buffer of any other capacity through
+ * @ref atlib_bufwrite_setbuf.
+ *
+ * When opened with @ref BUFWRITE_FD, the buffer is written straight to a file
+ * descriptor with @c write(2) instead of passing through a @c FILE.
+ *
+ * When moved onto a @c uring_t (see @ref atlib_bufwrite_uring), each full buffer is
+ * queued on the ring instead, and the stream keeps writing into a second buffer.
  *
  * @warning A valid Buffered Writer, or `bufwrite_t` object, is any Buffered Writer
  * that has been initialized through @c atlib_bufwrite_open. Usage of a non-valid
@@ -29,11 +40,19 @@ typedef __builtin_va_list va_list;
  * @see atlib_bufwrite_open
  * @see atlib_bufwrite_close
  */
+struct __bufwrite_queue;
+
 typedef struct {
-    FILE * fh;                          ///< @brief The file handler attached to this buffered writer.
+    FILE * fh;                          ///< @brief The file handler attached to this buffered writer, or @c nullptr when opened with @ref BUFWRITE_FD.
+    i32 fd;                             ///< @brief The file descriptor attached to this buffered writer.
+    u32 flags;                          ///< @brief Flags used to track extra features of this buffered writer.
+    usize off;                          ///< @brief The file position the start of the buffer will be written to.
     isize to_write;                     ///< @brief The number of bytes currently free in the buffer.
     char * next;                        ///< @brief The pointer to the next byte to write to.
-    char buf[__ATLIB_BUFWRITE_SIZE];    ///< @brief The buffer to store data.
+    char * base;                        ///< @brief The start of the buffer in use; @c buf unless replaced.
+    usize cap;                          ///< @brief The capacity of the buffer in use, in bytes.
+    struct __bufwrite_queue * queue;    ///< @brief The buffer queued on a ring, or @c nullptr when not on a ring.
+    char buf[__ATLIB_BUFWRITE_SIZE];    ///< @brief The default buffer to store data.
 } bufwrite_t;
 
 /**
@@ -45,6 +64,19 @@ typedef struct {
  */
 extern bufwrite_t * atlib_bufwrite_open(bufwrite_t *__restrict bw, const char *__restrict file_path);
 
+/**
+ * @brief Initializes @c bw to buffer outgoing inforamtion to the file referred to by @c file_path.
+ * @param bw Pointer to a @c bufwrite_t object.
+ * @param file_path Path to file to open.
+ * @param bw_flags Flags to configure this buffered stream. See @see bufwrite_flags.h
+ * @returns @c bw, pointing to a valid @c bufwrite_t object on success, or @c nullptr on error.
+ *
+ * The file is opened for appending, and created if it does not exist. If @c bw_flags
+ * contains @ref BUFWRITE_FD, the file is opened with @c open(2) and written with
+ * @c write(2), bypassing stdio.
+ */
+extern bufwrite_t * atlib_bufwrite_open_ex(bufwrite_t *__restrict bw, const char *__restrict file_path, u32 bw_flags);
+
 /**
  * @brief Initializes @c bw to buffer outgoing inforamtion to @c file.
  * @param bw Pointer to a @c bufwrite_t object.
@@ -53,16 +85,115 @@ extern bufwrite_t * atlib_bufwrite_open(bufwrite_t *__restrict bw, const char *_
  */
 extern bufwrite_t * atlib_bufwrite_fopen(bufwrite_t *__restrict bw, FILE *__restrict file);
 
+/**
+ * @brief Initializes @c bw to buffer outgoing inforamtion to the file descriptor @c fd.
+ * @param bw Pointer to a @c bufwrite_t object.
+ * @param fd An open file descriptor, writable with @c write(2).
+ * @returns @c bw, pointing to a valid @c bufwrite_t object on success, or @c nullptr on error.
+ *
+ * The caller is responsible for closing @c fd; @ref atlib_bufwrite_close only flushes it.
+ */
+extern bufwrite_t * atlib_bufwrite_fdopen(bufwrite_t * bw, i32 fd);
+
+/**
+ * @brief Initializes @c bw to write into a buffer in memory, which grows as needed.
+ * @param bw Pointer to a @c bufwrite_t object.
+ * @returns @c bw, pointing to a valid @c bufwrite_t object.
+ *
+ * Nothing is ever written out: where a file stream would flush its buffer, a memory
+ * stream doubles it instead, so every byte written stays in view and can be fetched
+ * with @ref atlib_bufwrite_membuf or @ref atlib_bufwrite_memtake. Small outputs stay in
+ * the internal buffer of @c bw and are never allocated at all; @ref atlib_bufwrite_setbuf
+ * may supply a larger starting buffer.
+ *
+ * @ref atlib_bufwrite_flush does nothing, and @ref atlib_bufwrite_close frees the buffer.
+ *
+ * Example:
+ * @code{.c}
+ * bufwrite_t bw;
+ * atlib_bufwrite_memopen(&bw);
+ * atlib_bufwrite_write_u32(&bw, id);
+ * atlib_bufwrite_write_uvarint(&bw, len);
+ * atlib_bufwrite_write(&bw, body, len);
+ *
+ * usize n;
+ * const char * msg = atlib_bufwrite_membuf(&bw, &n);
+ * send(sock, msg, n, 0);
+ * atlib_bufwrite_close(&bw);
+ * @endcode
+ *
+ * @see atlib_bufread_memopen
+ */
+extern bufwrite_t * atlib_bufwrite_memopen(bufwrite_t * bw);
+
+/**
+ * @brief Provides the bytes written so far to a memory stream.
+ * @param bw Pointer to a valid @c bufwrite_t object, opened with @ref atlib_bufwrite_memopen.
+ * @param len Pointer to store the number of bytes written in.
+ * @returns Pointer to the bytes written to @c bw.
+ *
+ * @warning The pointer is invalidated by the next write to, or the closing of, @c bw.
+ */
+extern const char * atlib_bufwrite_membuf(const bufwrite_t *__restrict bw, usize *__restrict len);
+
+/**
+ * @brief Hands the bytes written so far to a memory stream over to the caller, and empties the stream.
+ * @param bw Pointer to a valid @c bufwrite_t object, opened with @ref atlib_bufwrite_memopen.
+ * @param len Pointer to store the number of bytes written in.
+ * @returns A buffer holding the bytes written, to be released with @c free(3), or @c nullptr if it
+ * could not be allocated, in which case @c bw is left unchanged.
+ *
+ * A buffer allocated by AtLib is handed over as it is, without a copy. @c bw carries on
+ * in its internal buffer.
+ */
+extern void * atlib_bufwrite_memtake(bufwrite_t *__restrict bw, usize *__restrict len);
+
+/**
+ * @brief Empties a memory stream, keeping its buffer for the next bytes written.
+ * @param bw Pointer to a valid @c bufwrite_t object, opened with @ref atlib_bufwrite_memopen.
+ *
+ * Building message after message in one stream this way allocates only until the buffer
+ * has grown to fit the largest of them.
+ */
+extern void atlib_bufwrite_memreset(bufwrite_t * bw);
+
 /**
  * @brief Closes @c bw and uninitializes a valid @c bufwrite_t object.
  * @param bw Pointer to a valid @c bufwrite_t object.
  */
 extern void atlib_bufwrite_close(bufwrite_t * bw);
 
+/**
+ * @brief Replaces the buffer of @c bw with one of @c cap bytes.
+ * @param bw Pointer to a valid @c bufwrite_t object.
+ * @param buf Pointer to a buffer of at least @c cap bytes, or @c nullptr to have AtLib allocate one.
+ * @param cap Capacity of the new buffer, in bytes. Must be non-zero.
+ * @returns @c bw on success, or @c nullptr if the buffer could not be allocated, or the
+ * pending bytes in @c bw do not fit in @c cap.
+ *
+ * Pending bytes are carried over into the new buffer. A buffer allocated by AtLib is freed
+ * by @ref atlib_bufwrite_close; a buffer supplied by the caller must outlive @c bw.
+ * Streams moved onto a ring can no longer have their buffer replaced.
+ */
+extern bufwrite_t * atlib_bufwrite_setbuf(bufwrite_t *__restrict bw, void *__restrict buf, usize cap);
+
+/**
+ * @brief Moves @c bw onto @c ring, so that full buffers are queued there instead of written directly.
+ * @param bw Pointer to a valid @c bufwrite_t object, opened with @ref BUFWRITE_FD.
+ * @param ring Pointer to a valid @c uring_t object.
+ * @returns @c bw on success, or @c nullptr if @c bw cannot use @c ring, in which case it is left unchanged.
+ *
+ * Each time the buffer fills, it is queued on @c ring and @c bw carries on in a second buffer,
+ * without waiting. The queued write reaches the kernel together with the operations of every
+ * other stream on @c ring, and is only waited on once the second buffer fills in turn.
+ * @ref atlib_bufwrite_flush and @ref atlib_bufwrite_close still wait until every byte is written.
+ */
+extern bufwrite_t * atlib_bufwrite_uring(bufwrite_t * bw, uring_t * ring);
+
 /**
  * @brief Flushes all pending writes to the underlying media.
  * @param bw Pointer to a valid @c bw object.
- * @returns Number of bytes written to the underlying media.
+ * @returns Number of bytes written to the underlying media; always 0 for a memory stream.
  */
 extern usize atlib_bufwrite_flush(bufwrite_t * bw);
 
@@ -71,18 +202,41 @@ extern usize atlib_bufwrite_flush(bufwrite_t * bw);
  * @param bw Pointer to a valid @c bufwrite_t object.
  * @param data Pointer to an object to write.
  * @param n Number of bytes to write.
- * @returns Number of bytes written in the current buffer.
+ * @returns Number of bytes written to @c bw, which is less than @c n only if an error occured.
  *
- * If @c n is larger than what the current buffer is available is capable of holding, the remaining
- * space is filled and flushed, and the process is restarted with an empty buffer.
+ * If @c n is larger than the space left in the buffer, but smaller than the buffer, the remaining
+ * space is filled and flushed, and the rest starts an empty buffer. A payload at least as large as
+ * the buffer is never copied: it is handed to the kernel in a single @c writev(2), together with
+ * the bytes still pending in the buffer.
  */
 extern usize atlib_bufwrite_write(bufwrite_t *__restrict bw, const void *__restrict data, isize n);
 
+/**
+ * @brief Writes the @c cnt buffers described by @c iov to @c bw, in order.
+ * @param bw Pointer to a valid @c bufwrite_t object.
+ * @param iov Array of @c cnt buffers to write, as for @c writev(2).
+ * @param cnt Number of buffers in @c iov.
+ * @returns Number of bytes written to @c bw, which is less than the total only if an error occured.
+ *
+ * Buffers that fit in the space left are copied in as by @ref atlib_bufwrite_write. Otherwise
+ * nothing is copied: the pending bytes and every buffer of @c iov are gathered by the kernel in
+ * as few @c writev(2) calls as possible. A memory stream grows to fit them all instead.
+ */
+extern usize atlib_bufwrite_writev(bufwrite_t *__restrict bw, const struct iovec *__restrict iov, i32 cnt);
+
 /**
  * @brief Writes the formatted data to @c bw.
  * @param bw Pointer to a valid @c bufwrite_t object.
  * @param fmt String format to write to @c bw.
- * @returns Number of bytes written into the current buffer.
+ * @returns Number of bytes written to @c bw.
+ *
+ * @c fmt is formatted by AtLib itself, in a single pass, straight into the buffer of @c bw,
+ * which is flushed, or grown, whenever it fills up. Nothing is measured beforehand, and nothing
+ * is allocated, short of a single floating-point conversion longer than the whole buffer. Every specifier of @c printf is supported, with the same output, except for
+ * positional arguments (i.e. @c %1$d), which are written out as they are. Floating-point and
+ * wide character conversions are still formatted by the C library, one conversion at a time.
+ *
+ * If @c bw fails midway, the output is cut short there.
  */
 extern usize __attribute__((format (printf, 2, 3)))
     atlib_bufwrite_writef(bufwrite_t *__restrict bw, const char *__restrict fmt, ...);
@@ -92,85 +246,447 @@ extern usize __attribute__((format (printf, 2, 3)))
  * @param bw Pointer to a valid @c bufwrite_t object.
  * @param fmt String format to write to @c bw.
  * @param ap Variable argument list to format with.
- * @returns Number of bytes written into the current buffer.
+ * @returns Number of bytes written to @c bw.
+ *
+ * See @ref atlib_bufwrite_writef.
  */
 extern usize atlib_bufwrite_writefv(bufwrite_t *__restrict bw, const char *__restrict fmt, va_list ap);
 
 /**
- * @brief Writes raw bytes of @c v to @c bw.
+ * @brief Writes @c v to @c bw as decimal text, i.e. @c 18446744073709551615.
  * @param bw Pointer to a valid @c bufwrite_t object.
- * @param v Bytes to write to @c bw.
+ * @param v Value to write to @c bw.
+ * @returns Number of bytes written to @c bw, or 0 if an error occured.
+ *
+ * The number of digits comes from the bit length of @c v and a single comparison, and the
+ * digits are written straight into the buffer two at a time, from a table of digit pairs.
+ * Same output as @c writef("%lu"), without parsing a format.
  */
-extern void atlib_bufwrite_write_u8(bufwrite_t *__restrict bw, u8 v);
+extern usize atlib_bufwrite_write_dec_u64(bufwrite_t * bw, u64 v);
 
 /**
- * @brief Writes raw bytes of @c v to @c bw.
+ * @brief Writes @c v to @c bw as decimal text, i.e. @c -42.
  * @param bw Pointer to a valid @c bufwrite_t object.
- * @param v Bytes to write to @c bw.
+ * @param v Value to write to @c bw.
+ * @returns Number of bytes written to @c bw, or 0 if an error occured.
+ *
+ * See @ref atlib_bufwrite_write_dec_u64.
  */
-extern void atlib_bufwrite_write_u16(bufwrite_t *__restrict bw, u16 v);
+extern usize atlib_bufwrite_write_dec_i64(bufwrite_t * bw, i64 v);
 
 /**
- * @brief Writes raw bytes of @c v to @c bw.
+ * @brief Writes @c v to @c bw as lowercase hexadecimal text, without a prefix, i.e. @c 7fff.
  * @param bw Pointer to a valid @c bufwrite_t object.
- * @param v Bytes to write to @c bw.
+ * @param v Value to write to @c bw.
+ * @returns Number of bytes written to @c bw, or 0 if an error occured.
  */
-extern void atlib_bufwrite_write_u32(bufwrite_t *__restrict bw, u32 v);
+extern usize atlib_bufwrite_write_hex_u64(bufwrite_t * bw, u64 v);
 
 /**
- * @brief Writes raw bytes of @c v to @c bw.
+ * @brief Writes @c v to @c bw as the shortest decimal text that reads back as exactly @c v.
  * @param bw Pointer to a valid @c bufwrite_t object.
- * @param v Bytes to write to @c bw.
+ * @param v Value to write to @c bw.
+ * @returns Number of bytes written to @c bw, or 0 if an error occured.
+ *
+ * Digits are generated with Grisu2, in 64-bit integer arithmetic, so @c 0.1 is written as
+ * @c 0.1 rather than @c 0.10000000000000001. Whatever is written parses back, with @c strtod
+ * or @ref atlib_bufread_parse_f64, to the same double.
+ *
+ * Values from @c 1e-6 up to @c 1e21 are written as plain decimals (@c 123.456, @c 0.00025,
+ * @c 1500), and others in scientific notation (@c 1.5e21, @c 2.5e-7). Integral values have
+ * no fractional part. Zero is written as @c 0 or @c -0, and the special values as @c inf,
+ * @c -inf, and @c nan.
  */
-extern void atlib_bufwrite_write_u64(bufwrite_t *__restrict bw, u64 v);
+extern usize atlib_bufwrite_write_f64(bufwrite_t * bw, f64 v);
+
+/**
+ * @brief Writes the @c n bytes at @c v to @c bw once they do not fit in what is left of its buffer.
+ * Internal to AtLib; the cold path of the inline writers below.
+ * @returns Non-zero if all @c n bytes were written.
+ */
+extern i32 __atlib_bufwrite_spill(bufwrite_t *__restrict bw, const void *__restrict v, usize n) __attribute__((nonnull, nothrow, cold));
+
+/*
+ * The fixed-width functions below are defined here, so that callers inline them, and are also
+ * exported from the library: its own translation unit defines __ATLIB_BUFWRITE_INLINE_EXPORT
+ * before including this header, and so emits their out-of-line definitions.
+ */
+#ifdef __ATLIB_BUFWRITE_INLINE_EXPORT
+#define __ATLIB_BUFWRITE_INLINE extern
+#else
+#define __ATLIB_BUFWRITE_INLINE extern inline __attribute__((gnu_inline))
+#endif
+
+/*
+ * Copies the `n` bytes at `v` into `bw`; returns 0 if they could not be written.
+ * The fixed-width writers below are built on this, so each compiles down to at most one byte swap,
+ * a bounds check, and one unaligned store, with the flush kept out of line.
+ */
+__ATLIB_BUFWRITE_INLINE i32 __atlib_bufwrite_put(bufwrite_t * bw, const void * v, usize n) {
+    if(__builtin_expect((usize)bw->to_write < n, 0)) return __atlib_bufwrite_spill(bw, v, n);
+    __builtin_memcpy(bw->next, v, n);
+    bw->next += n;
+    bw->to_write -= n;
+    return 1;
+}
 
 /**
  * @brief Writes raw bytes of @c v to @c bw.
  * @param bw Pointer to a valid @c bufwrite_t object.
  * @param v Bytes to write to @c bw.
  */
-extern void atlib_bufwrite_write_i8(bufwrite_t *__restrict bw, i8 v);
+__ATLIB_BUFWRITE_INLINE void atlib_bufwrite_write_u8(bufwrite_t * bw, u8 v) {
+    __atlib_bufwrite_put(bw, &v, sizeof(v));
+}
 
 /**
- * @brief Writes raw bytes of @c v to @c bw.
+ * @brief Writes @c v to @c bw in big-endian format.
  * @param bw Pointer to a valid @c bufwrite_t object.
- * @param v Bytes to write to @c bw.
+ * @param v Value to write to @c bw.
  */
-extern void atlib_bufwrite_write_i16(bufwrite_t *__restrict bw, i16 v);
+__ATLIB_BUFWRITE_INLINE void atlib_bufwrite_write_u16(bufwrite_t * bw, u16 v) {
+    const u16 x = ATLIB_BE16(v);
+    __atlib_bufwrite_put(bw, &x, sizeof(x));
+}
 
 /**
- * @brief Writes raw bytes of @c v to @c bw.
+ * @brief Writes @c v to @c bw in big-endian format.
  * @param bw Pointer to a valid @c bufwrite_t object.
- * @param v Bytes to write to @c bw.
+ * @param v Value to write to @c bw.
  */
-extern void atlib_bufwrite_write_i32(bufwrite_t *__restrict bw, i32 v);
+__ATLIB_BUFWRITE_INLINE void atlib_bufwrite_write_u32(bufwrite_t * bw, u32 v) {
+    const u32 x = ATLIB_BE32(v);
+    __atlib_bufwrite_put(bw, &x, sizeof(x));
+}
+
+/**
+ * @brief Writes @c v to @c bw in big-endian format.
+ * @param bw Pointer to a valid @c bufwrite_t object.
+ * @param v Value to write to @c bw.
+ */
+__ATLIB_BUFWRITE_INLINE void atlib_bufwrite_write_u64(bufwrite_t * bw, u64 v) {
+    const u64 x = ATLIB_BE64(v);
+    __atlib_bufwrite_put(bw, &x, sizeof(x));
+}
 
 /**
  * @brief Writes raw bytes of @c v to @c bw.
  * @param bw Pointer to a valid @c bufwrite_t object.
  * @param v Bytes to write to @c bw.
  */
-extern void atlib_bufwrite_write_i64(bufwrite_t *__restrict bw, i64 v);
+__ATLIB_BUFWRITE_INLINE void atlib_bufwrite_write_i8(bufwrite_t * bw, i8 v) {
+    __atlib_bufwrite_put(bw, &v, sizeof(v));
+}
+
+/**
+ * @brief Writes @c v to @c bw in big-endian format.
+ * @param bw Pointer to a valid @c bufwrite_t object.
+ * @param v Value to write to @c bw.
+ */
+__ATLIB_BUFWRITE_INLINE void atlib_bufwrite_write_i16(bufwrite_t * bw, i16 v) {
+    const u16 x = ATLIB_BE16((u16)v);
+    __atlib_bufwrite_put(bw, &x, sizeof(x));
+}
+
+/**
+ * @brief Writes @c v to @c bw in big-endian format.
+ * @param bw Pointer to a valid @c bufwrite_t object.
+ * @param v Value to write to @c bw.
+ */
+__ATLIB_BUFWRITE_INLINE void atlib_bufwrite_write_i32(bufwrite_t * bw, i32 v) {
+    const u32 x = ATLIB_BE32((u32)v);
+    __atlib_bufwrite_put(bw, &x, sizeof(x));
+}
+
+/**
+ * @brief Writes @c v to @c bw in big-endian format.
+ * @param bw Pointer to a valid @c bufwrite_t object.
+ * @param v Value to write to @c bw.
+ */
+__ATLIB_BUFWRITE_INLINE void atlib_bufwrite_write_i64(bufwrite_t * bw, i64 v) {
+    const u64 x = ATLIB_BE64((u64)v);
+    __atlib_bufwrite_put(bw, &x, sizeof(x));
+}
+
+/**
+ * @brief Writes @c v to @c bw as an unsigned LEB128 varint, using 1 to 10 bytes.
+ * @param bw Pointer to a valid @c bufwrite_t object.
+ * @param v Value to write to @c bw.
+ *
+ * Small values take fewer bytes: every 7 bits of @c v take one byte, so values below 128 take one.
+ *
+ * @see atlib_bufread_read_uvarint
+ */
+extern void atlib_bufwrite_write_uvarint(bufwrite_t *__restrict bw, u64 v);
+
+/**
+ * @brief Writes @c v to @c bw as a zigzag-encoded LEB128 varint, using 1 to 10 bytes.
+ * @param bw Pointer to a valid @c bufwrite_t object.
+ * @param v Value to write to @c bw.
+ *
+ * Zigzag encoding interleaves negative and positive values (0, -1, 1, -2, ...) so that
+ * values close to zero, of either sign, take few bytes.
+ *
+ * @see atlib_bufread_read_svarint
+ */
+extern void atlib_bufwrite_write_svarint(bufwrite_t *__restrict bw, i64 v);
+
+/**
+ * @brief Writes the @c n values of type @c u16 at @c src to @c bw, in big-endian format.
+ * @param bw Pointer to a valid @c bufwrite_t object.
+ * @param src Pointer to an array of @c n values.
+ * @param n Number of values to write.
+ * @returns Number of values written, which is less than @c n only if an error occured.
+ *
+ * The values are swapped straight into the buffer with SIMD byte shuffles when the host's byte order
+ * differs from the one written, as many at a time as fit, and copied as they are otherwise.
+ * Use this instead of calling @ref atlib_bufwrite_write_u16 in a loop.
+ *
+ * @see atlib_bufwrite_write_u16_array_be
+ * @see atlib_bufwrite_write_u16_array_le
+ * @see atlib_bufwrite_write_u16_array_native
+ */
+extern usize atlib_bufwrite_write_u16_array(bufwrite_t *__restrict bw, const u16 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c u16 at @c src to @c bw, in big-endian format.
+ * @see atlib_bufwrite_write_u16_array
+ */
+extern usize atlib_bufwrite_write_u16_array_be(bufwrite_t *__restrict bw, const u16 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c u16 at @c src to @c bw, in little-endian format.
+ * @see atlib_bufwrite_write_u16_array
+ */
+extern usize atlib_bufwrite_write_u16_array_le(bufwrite_t *__restrict bw, const u16 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c u16 at @c src to @c bw, in the byte order of the host.
+ *
+ * Nothing is converted: the array is written as by @ref atlib_bufwrite_write, so a large one
+ * goes to the file without being copied into the buffer.
+ *
+ * @see atlib_bufwrite_write_u16_array
+ */
+extern usize atlib_bufwrite_write_u16_array_native(bufwrite_t *__restrict bw, const u16 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c u32 at @c src to @c bw, in big-endian format.
+ * @param bw Pointer to a valid @c bufwrite_t object.
+ * @param src Pointer to an array of @c n values.
+ * @param n Number of values to write.
+ * @returns Number of values written, which is less than @c n only if an error occured.
+ *
+ * The values are swapped straight into the buffer with SIMD byte shuffles when the host's byte order
+ * differs from the one written, as many at a time as fit, and copied as they are otherwise.
+ * Use this instead of calling @ref atlib_bufwrite_write_u32 in a loop.
+ *
+ * @see atlib_bufwrite_write_u32_array_be
+ * @see atlib_bufwrite_write_u32_array_le
+ * @see atlib_bufwrite_write_u32_array_native
+ */
+extern usize atlib_bufwrite_write_u32_array(bufwrite_t *__restrict bw, const u32 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c u32 at @c src to @c bw, in big-endian format.
+ * @see atlib_bufwrite_write_u32_array
+ */
+extern usize atlib_bufwrite_write_u32_array_be(bufwrite_t *__restrict bw, const u32 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c u32 at @c src to @c bw, in little-endian format.
+ * @see atlib_bufwrite_write_u32_array
+ */
+extern usize atlib_bufwrite_write_u32_array_le(bufwrite_t *__restrict bw, const u32 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c u32 at @c src to @c bw, in the byte order of the host.
+ *
+ * Nothing is converted: the array is written as by @ref atlib_bufwrite_write, so a large one
+ * goes to the file without being copied into the buffer.
+ *
+ * @see atlib_bufwrite_write_u32_array
+ */
+extern usize atlib_bufwrite_write_u32_array_native(bufwrite_t *__restrict bw, const u32 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c u64 at @c src to @c bw, in big-endian format.
+ * @param bw Pointer to a valid @c bufwrite_t object.
+ * @param src Pointer to an array of @c n values.
+ * @param n Number of values to write.
+ * @returns Number of values written, which is less than @c n only if an error occured.
+ *
+ * The values are swapped straight into the buffer with SIMD byte shuffles when the host's byte order
+ * differs from the one written, as many at a time as fit, and copied as they are otherwise.
+ * Use this instead of calling @ref atlib_bufwrite_write_u64 in a loop.
+ *
+ * @see atlib_bufwrite_write_u64_array_be
+ * @see atlib_bufwrite_write_u64_array_le
+ * @see atlib_bufwrite_write_u64_array_native
+ */
+extern usize atlib_bufwrite_write_u64_array(bufwrite_t *__restrict bw, const u64 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c u64 at @c src to @c bw, in big-endian format.
+ * @see atlib_bufwrite_write_u64_array
+ */
+extern usize atlib_bufwrite_write_u64_array_be(bufwrite_t *__restrict bw, const u64 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c u64 at @c src to @c bw, in little-endian format.
+ * @see atlib_bufwrite_write_u64_array
+ */
+extern usize atlib_bufwrite_write_u64_array_le(bufwrite_t *__restrict bw, const u64 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c u64 at @c src to @c bw, in the byte order of the host.
+ *
+ * Nothing is converted: the array is written as by @ref atlib_bufwrite_write, so a large one
+ * goes to the file without being copied into the buffer.
+ *
+ * @see atlib_bufwrite_write_u64_array
+ */
+extern usize atlib_bufwrite_write_u64_array_native(bufwrite_t *__restrict bw, const u64 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c f32 at @c src to @c bw, in big-endian format.
+ * @param bw Pointer to a valid @c bufwrite_t object.
+ * @param src Pointer to an array of @c n values.
+ * @param n Number of values to write.
+ * @returns Number of values written, which is less than @c n only if an error occured.
+ *
+ * The values are swapped straight into the buffer with SIMD byte shuffles when the host's byte order
+ * differs from the one written, as many at a time as fit, and copied as they are otherwise.
+ *
+ * @see atlib_bufwrite_write_f32_array_be
+ * @see atlib_bufwrite_write_f32_array_le
+ * @see atlib_bufwrite_write_f32_array_native
+ */
+extern usize atlib_bufwrite_write_f32_array(bufwrite_t *__restrict bw, const f32 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c f32 at @c src to @c bw, in big-endian format.
+ * @see atlib_bufwrite_write_f32_array
+ */
+extern usize atlib_bufwrite_write_f32_array_be(bufwrite_t *__restrict bw, const f32 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c f32 at @c src to @c bw, in little-endian format.
+ * @see atlib_bufwrite_write_f32_array
+ */
+extern usize atlib_bufwrite_write_f32_array_le(bufwrite_t *__restrict bw, const f32 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c f32 at @c src to @c bw, in the byte order of the host.
+ *
+ * Nothing is converted: the array is written as by @ref atlib_bufwrite_write, so a large one
+ * goes to the file without being copied into the buffer.
+ *
+ * @see atlib_bufwrite_write_f32_array
+ */
+extern usize atlib_bufwrite_write_f32_array_native(bufwrite_t *__restrict bw, const f32 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c f64 at @c src to @c bw, in big-endian format.
+ * @param bw Pointer to a valid @c bufwrite_t object.
+ * @param src Pointer to an array of @c n values.
+ * @param n Number of values to write.
+ * @returns Number of values written, which is less than @c n only if an error occured.
+ *
+ * The values are swapped straight into the buffer with SIMD byte shuffles when the host's byte order
+ * differs from the one written, as many at a time as fit, and copied as they are otherwise.
+ *
+ * @see atlib_bufwrite_write_f64_array_be
+ * @see atlib_bufwrite_write_f64_array_le
+ * @see atlib_bufwrite_write_f64_array_native
+ */
+extern usize atlib_bufwrite_write_f64_array(bufwrite_t *__restrict bw, const f64 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c f64 at @c src to @c bw, in big-endian format.
+ * @see atlib_bufwrite_write_f64_array
+ */
+extern usize atlib_bufwrite_write_f64_array_be(bufwrite_t *__restrict bw, const f64 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c f64 at @c src to @c bw, in little-endian format.
+ * @see atlib_bufwrite_write_f64_array
+ */
+extern usize atlib_bufwrite_write_f64_array_le(bufwrite_t *__restrict bw, const f64 *__restrict src, usize n);
+
+/**
+ * @brief Writes the @c n values of type @c f64 at @c src to @c bw, in the byte order of the host.
+ *
+ * Nothing is converted: the array is written as by @ref atlib_bufwrite_write, so a large one
+ * goes to the file without being copied into the buffer.
+ *
+ * @see atlib_bufwrite_write_f64_array
+ */
+extern usize atlib_bufwrite_write_f64_array_native(bufwrite_t *__restrict bw, const f64 *__restrict src, usize n);
+
+/**
+ * @brief Makes room for @c n contiguous bytes in the buffer of @c bw, once they do not fit in what is left of it.
+ * Internal to AtLib; the cold path of @ref atlib_bufwrite_reserve.
+ * @returns Pointer to the free bytes, or @c nullptr if they could not be made room for.
+ */
+extern void * __atlib_bufwrite_reserve(bufwrite_t * bw, usize n) __attribute__((nonnull, nothrow, cold));
+
+/**
+ * @brief Provides at least @c n contiguous free bytes in the buffer of @c bw, for a value to be encoded into in place.
+ * @param bw Pointer to a valid @c bufwrite_t object.
+ * @param n Number of bytes needed. For a stream other than a memory stream, at most the capacity of its buffer.
+ * @returns Pointer to at least @c n free bytes, or @c nullptr if @c n exceeds the capacity of the buffer,
+ * or @c bw is errored.
+ *
+ * The buffer is flushed, or grown for a memory stream, only when fewer than @c n bytes are left in it.
+ * Nothing is written until @ref atlib_bufwrite_commit publishes the bytes actually used, which saves
+ * encoding into a scratch array and copying it over with @ref atlib_bufwrite_write.
+ *
+ * Example:
+ * @code{.c}
+ * char * p = atlib_bufwrite_reserve(&bw, 10 + len);
+ * if(p == nullptr) { /\* Handle Error Here *\/ }
+ * usize used = encode_record(p, rec);
+ * atlib_bufwrite_commit(&bw, used);
+ * @endcode
+ *
+ * @warning The pointer is invalidated by any other call on @c bw, including another reserve.
+ * @see atlib_bufwrite_commit
+ */
+static inline void * atlib_bufwrite_reserve(bufwrite_t * bw, usize n) {
+    if(__builtin_expect((usize)bw->to_write < n, 0)) return __atlib_bufwrite_reserve(bw, n);
+    return bw->next;
+}
+
+/**
+ * @brief Publishes the first @c used bytes of the room last provided by @ref atlib_bufwrite_reserve.
+ * @param bw Pointer to a valid @c bufwrite_t object.
+ * @param used Number of bytes written at the reserved pointer. Must not exceed what was reserved.
+ */
+static inline void atlib_bufwrite_commit(bufwrite_t * bw, usize used) {
+    bw->next += used;
+    bw->to_write -= used;
+}
 
 /**
  * @brief Finds the byte position of the current stream.
  * @param bw Pointer to the stream.
  * @returns Byte position of the current stream.
  */
-static inline usize atlib_bufwrite_pos(const bufwrite_t * bw) { return ftell(bw->fh) + __ATLIB_BUFWRITE_SIZE - bw->to_write; }
+static inline usize atlib_bufwrite_pos(const bufwrite_t * bw) { return bw->off + bw->cap - bw->to_write; }
 
 /**
  * @brief Finds the byte position of the unbuffered stream.
  * @param bw Pointer to the stream.
  * @returns Byte position of the current underlying stream.
  */
-static inline usize atlib_bufwrite_fpos(const bufwrite_t * bw) { return ftell(bw->fh); }
+static inline usize atlib_bufwrite_fpos(const bufwrite_t * bw) { return bw->off; }
 
 /**
  * @brief Checks if the stream is errored.
  * @param bw Pointer to the stream.
  * @returns Non-zero if the stream is errored, zero otherwise.
  */
-static inline usize atlib_bufwrite_err(const bufwrite_t * bw) { return ferror(bw->fh); }
+static inline usize atlib_bufwrite_err(const bufwrite_t * bw) { return bw->flags & BUFWRITE_ERR; }
 
 #endif
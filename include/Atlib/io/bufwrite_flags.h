@@ -0,0 +1,51 @@
+#ifndef __ATLIB_BUFWRITE_FLAGS_H
+#define __ATLIB_BUFWRITE_FLAGS_H
+
+/**
+ * @file bufwrite_flags.h
+ */
+
+#include "Atlib/types.h"
+
+/**
+ * @def BUFWRITE_FH_ATTACH
+ * @brief Describes that this stream has an attached file descriptor handled external
+ * of AtLib, avoiding cleaning the file up when closing the stream.
+ */
+#define BUFWRITE_FH_ATTACH      ((u32)(1))
+
+/**
+ * @def BUFWRITE_FD
+ * @brief Signals that this stream writes to a raw file descriptor with @c write(2),
+ * bypassing stdio and its internal buffer entirely.
+ */
+#define BUFWRITE_FD             ((u32)(1 << 1))
+
+/**
+ * @def BUFWRITE_BUF_ALLOC
+ * @brief Set by AtLib when the stream's buffer was allocated by @ref atlib_bufwrite_setbuf,
+ * and must be freed when the stream is closed.
+ */
+#define BUFWRITE_BUF_ALLOC      ((u32)(1 << 2))
+
+/**
+ * @def BUFWRITE_MEM
+ * @brief Set by AtLib when the stream writes into a growable buffer in memory
+ * (see @ref atlib_bufwrite_memopen) instead of a file.
+ */
+#define BUFWRITE_MEM            ((u32)(1 << 3))
+
+/**
+ * @def BUFWRITE_ERR
+ * @brief Set by AtLib once the stream has encountered an error, and cannot continue to write.
+ */
+#define BUFWRITE_ERR            ((u32)1 << 31)
+
+/**
+ * @def BUFWRITE_FLAG_DEFAULT
+ * @brief Default set of flags to fallback on when creating a buffered stream,
+ * when the user does not provide any to AtLib.
+ */
+#define BUFWRITE_FLAG_DEFAULT   ((u32)(0))
+
+#endif
@@ -24,4 +24,58 @@
 
 #define ATLIB_WORDSIZE ((i32)(sizeof(void *)))
 
+/**
+ * @def ATLIB_BE16(v)
+ * @brief Converts the 16-bit value @c v between big-endian and host byte order; converting twice gives back @c v.
+ *
+ * @ref ATLIB_BE32, @ref ATLIB_BE64, and the little-endian @ref ATLIB_LE16, @ref ATLIB_LE32, and
+ * @ref ATLIB_LE64 do the same for their own width and byte order. Each one is either nothing,
+ * or a single @c __builtin_bswap, which compiles down to one instruction.
+ */
+#if ATLIB_ENDIAN == ATLIB_LITTLE_ENDIAN
+#define ATLIB_BE16(v)   __builtin_bswap16(v)
+#define ATLIB_BE32(v)   __builtin_bswap32(v)
+#define ATLIB_BE64(v)   __builtin_bswap64(v)
+#define ATLIB_LE16(v)   ((u16)(v))
+#define ATLIB_LE32(v)   ((u32)(v))
+#define ATLIB_LE64(v)   ((u64)(v))
+#else
+#define ATLIB_BE16(v)   ((u16)(v))
+#define ATLIB_BE32(v)   ((u32)(v))
+#define ATLIB_BE64(v)   ((u64)(v))
+#define ATLIB_LE16(v)   __builtin_bswap16(v)
+#define ATLIB_LE32(v)   __builtin_bswap32(v)
+#define ATLIB_LE64(v)   __builtin_bswap64(v)
+#endif
+
+/**
+ * @brief Copies @c n 16-bit values from @c src to @c dst, reversing the byte order of each.
+ * @param dst Pointer to the destination. May be equal to @c src, but must not otherwise overlap it.
+ * @param src Pointer to the values to swap. Neither pointer needs to be aligned.
+ * @param n Number of values to swap.
+ *
+ * Uses SIMD byte shuffles (AVX2, SSSE3, or SSE2) when available, and @c __builtin_bswap16 otherwise.
+ */
+extern void atlib_bswap16_array(void * dst, const void * src, usize n) __attribute__((nonnull, nothrow));
+
+/**
+ * @brief Copies @c n 32-bit values from @c src to @c dst, reversing the byte order of each.
+ * @param dst Pointer to the destination. May be equal to @c src, but must not otherwise overlap it.
+ * @param src Pointer to the values to swap. Neither pointer needs to be aligned.
+ * @param n Number of values to swap.
+ *
+ * Uses SIMD byte shuffles (AVX2, SSSE3, or SSE2) when available, and @c __builtin_bswap32 otherwise.
+ */
+extern void atlib_bswap32_array(void * dst, const void * src, usize n) __attribute__((nonnull, nothrow));
+
+/**
+ * @brief Copies @c n 64-bit values from @c src to @c dst, reversing the byte order of each.
+ * @param dst Pointer to the destination. May be equal to @c src, but must not otherwise overlap it.
+ * @param src Pointer to the values to swap. Neither pointer needs to be aligned.
+ * @param n Number of values to swap.
+ *
+ * Uses SIMD byte shuffles (AVX2, SSSE3, or SSE2) when available, and @c __builtin_bswap64 otherwise.
+ */
+extern void atlib_bswap64_array(void * dst, const void * src, usize n) __attribute__((nonnull, nothrow));
+
 #endif
@@ -0,0 +1,118 @@
+#ifndef __ATLIB_URING_H
+#define __ATLIB_URING_H
+
+/**
+ * @file uring.h
+ * @brief Defines a shared @c io_uring submission ring that batches the I/O of many buffered streams.
+ */
+
+#include "Atlib/types.h"
+
+/**
+ * @brief An @c io_uring instance shared by any number of buffered streams.
+ *
+ * Streams moved onto a ring (see @ref atlib_bufread_uring and @ref atlib_bufwrite_uring)
+ * no longer call @c read(2) or @c write(2) themselves. Instead, each stream queues its
+ * next read or its last full buffer on the ring, and the queued operations of every stream
+ * are handed to the kernel together, in a single @c io_uring_enter(2), either by
+ * @ref atlib_uring_submit or the first time any stream has to wait on its own operation.
+ *
+ * A process that multiplexes hundreds of streams can therefore queue work on all of them,
+ * submit once, and only pay for a system call when a stream actually runs dry.
+ *
+ * The ring is driven by raw system calls, so no extra library is needed. If the kernel
+ * does not support @c io_uring, or it is blocked (i.e. by a seccomp profile),
+ * @ref atlib_uring_open fails and streams simply keep their regular read and write paths.
+ *
+ * @warning A ring, and every stream moved onto it, must be used from a single thread.
+ *
+ * @see atlib_uring_open
+ * @see atlib_uring_close
+ */
+typedef struct {
+    i32 fd;                             ///< @brief The file descriptor of the ring.
+    u32 entries;                        ///< @brief The number of entries in the submission queue.
+    u32 queued;                         ///< @brief The number of operations queued but not yet submitted.
+    u32 * sq_head;                      ///< @brief The head of the submission queue, advanced by the kernel.
+    u32 * sq_tail;                      ///< @brief The tail of the submission queue, advanced by AtLib.
+    u32 * sq_array;                     ///< @brief The submission queue's array of entry indices.
+    u32 sq_mask;                        ///< @brief The mask applied to submission queue indices.
+    void * sqes;                        ///< @brief The submission queue entries.
+    u32 * cq_head;                      ///< @brief The head of the completion queue, advanced by AtLib.
+    u32 * cq_tail;                      ///< @brief The tail of the completion queue, advanced by the kernel.
+    u32 cq_mask;                        ///< @brief The mask applied to completion queue indices.
+    void * cqes;                        ///< @brief The completion queue entries.
+    void * sq_map;                      ///< @brief The mapping holding the submission ring.
+    usize sq_len;                       ///< @brief The length of @c sq_map, in bytes.
+    void * cq_map;                      ///< @brief The mapping holding the completion ring; may equal @c sq_map.
+    usize cq_len;                       ///< @brief The length of @c cq_map, in bytes.
+    usize sqes_len;                     ///< @brief The length of @c sqes, in bytes.
+} uring_t;
+
+/**
+ * @brief Tracks a single operation queued on a @c uring_t by a stream.
+ *
+ * Internal to AtLib; streams keep one of these for each operation they have in flight.
+ */
+struct __atlib_uring_op {
+    i32 res;                            ///< @brief The result of the operation, as @c read(2) or @c write(2) would return it, or @c -errno.
+    i32 done;                           ///< @brief Non-zero once @c res holds the result.
+};
+
+/**
+ * @brief Initializes @c ring with room for @c entries operations per submission.
+ * @param ring Pointer to a @c uring_t object.
+ * @param entries The size of the submission queue. Rounded up to a power of two by the kernel.
+ * @returns Pointer to @c ring on success, or @c nullptr if @c io_uring is unavailable.
+ *
+ * Failing here is expected on older kernels and inside restricted containers. Callers
+ * should carry on without a ring, as every stream works the same without one.
+ *
+ * Example:
+ * @code{.c}
+ * uring_t ring;
+ * uring_t * r = atlib_uring_open(&ring, 256);
+ *
+ * for(u32 i = 0; i < n; i++) {
+ *     atlib_bufread_open(&in[i], paths[i], BUFREAD_FD);
+ *     if(r) atlib_bufread_uring(&in[i], r);
+ * }
+ * if(r) atlib_uring_submit(r);    /\* One system call starts every read *\/
+ * @endcode
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI uring_t * atlib_uring_open(uring_t * ring, u32 entries);
+
+/**
+ * @brief Releases @c ring.
+ * @param ring Pointer to a valid @c uring_t object.
+ *
+ * @warning Every stream moved onto @c ring must be closed first.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI void atlib_uring_close(uring_t * ring);
+
+/**
+ * @brief Hands every operation queued on @c ring to the kernel in one system call, without waiting.
+ * @param ring Pointer to a valid @c uring_t object.
+ * @returns The number of operations submitted.
+ *
+ * @since AtLib v1.1.0
+ */
+ATAPI u32 atlib_uring_submit(uring_t * ring);
+
+/**
+ * @brief Queues a read or write of @c n bytes at the file's current position. Internal to AtLib.
+ * @returns 1 on success, or 0 if the operation could not be queued.
+ */
+extern i32 __atlib_uring_queue(uring_t * ring, struct __atlib_uring_op * op, i32 write, i32 fd, void * buf, u32 n)
+    __attribute__((nonnull, nothrow));
+
+/**
+ * @brief Submits whatever is queued on @c ring and blocks until @c op completes. Internal to AtLib.
+ */
+extern void __atlib_uring_wait(uring_t * ring, struct __atlib_uring_op * op) __attribute__((nonnull, nothrow));
+
+#endif
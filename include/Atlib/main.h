@@ -8,6 +8,10 @@
 
 #include "Atlib/io/bufread.h"
 #include "Atlib/io/bufwrite.h"
+#include "Atlib/io/bufsplit.h"
+#include "Atlib/io/bufcsv.h"
+#include "Atlib/io/bufread_define.h"
+#include "Atlib/io/bufrecord.h"
 
 #ifndef __ATLIB_NEED_MAIN
 
@@ -0,0 +1,164 @@
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__PCLMUL__)
+#include <wmmintrin.h>
+#endif
+
+#include "Atlib/io/bufcsv.h"
+#include "Atlib/error.h"
+
+#define __BLOCK 64
+
+/* Bitmask of the bytes equal to `c` in the 64 bytes at `p` */
+static inline u64 __eq64(const char * p, const char c) {
+#if defined(__AVX2__)
+    const __m256i needle = _mm256_set1_epi8(c);
+    return (u64)(u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)p), needle))
+        | (u64)(u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(p + 32)), needle)) << 32;
+#elif defined(__SSE2__)
+    const __m128i needle = _mm_set1_epi8(c);
+    return (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), needle))
+        | (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 16)), needle)) << 16
+        | (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 32)), needle)) << 32
+        | (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 48)), needle)) << 48;
+#else
+    u64 m = 0;
+    for(usize i = 0; i < __BLOCK; i++) m |= (u64)(p[i] == c) << i;
+    return m;
+#endif
+}
+
+/* Sets every bit from each set bit up to, but not including, the next one */
+static inline u64 __prefix_xor(u64 x) {
+#if defined(__PCLMUL__)
+    return _mm_cvtsi128_si64(_mm_clmulepi64_si128(_mm_set_epi64x(0, x), _mm_set1_epi8(-1), 0));
+#else
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+#endif
+}
+
+/* Appends [p, end) as the next field, without its enclosing quotes; returns 0 if `fields` cannot grow */
+static inline i32 __push(bufcsv_t * self, const char * p, const char * end) {
+    if(self->nfields == self->cap) {
+        const usize cap = self->cap * 2;
+        bufview_t * fields = realloc(self->fields, cap * sizeof(*fields));
+        if(fields == NULL) return 0;
+
+        self->fields = fields;
+        self->cap = cap;
+    }
+
+    if(self->quote && end - p >= 2 && *p == self->quote && end[-1] == self->quote) p++, end--;
+    self->fields[self->nfields++] = (bufview_t){ .ptr = p, .len = end - p };
+    return 1;
+}
+
+bufcsv_t * atlib_bufcsv_open(bufcsv_t * restrict self, bufread_t * restrict br, char delim, char quote) {
+    atlib_compassert(self);
+    atlib_compassert(br);
+    atlib_compassert(delim != '\n');
+    atlib_compassert(delim != quote);
+
+    self->cap = 16;
+    self->fields = malloc(self->cap * sizeof(*self->fields));
+    if(self->fields == NULL) return NULL;
+
+    self->br = br;
+    self->nfields = 0;
+    self->delim = delim;
+    self->quote = quote;
+    return self;
+}
+
+void atlib_bufcsv_close(bufcsv_t * self) {
+    atlib_compassert(self);
+
+    free(self->fields);
+    self->fields = nullptr;
+    self->nfields = 0;
+    self->cap = 0;
+}
+
+i32 atlib_bufcsv_next(bufcsv_t * self) {
+    atlib_compassert(self);
+    atlib_compassert(self->fields);
+
+    bufread_t * const br = self->br;
+    i32 last = 0;
+
+    if(br->to_read == 0 && __atlib_bufread_more(br) == 0) return 0;
+
+    for(;;) {
+        const char * const start = br->next;
+        const char * const end = start + br->to_read;
+        const char * field = start;
+        u64 inside = 0;
+
+        self->nfields = 0;
+
+        for(const char * p = start; p < end; p += __BLOCK) {
+            /* The final partial block is copied out, so no load runs past the buffer */
+            char tail[__BLOCK];
+            const char * blk = p;
+            u64 valid = ~(u64)0;
+            if(end - p < __BLOCK) {
+                memset(tail, 0, sizeof(tail));
+                memcpy(tail, p, end - p);
+                blk = tail;
+                valid = ((u64)1 << (end - p)) - 1;
+            }
+
+            /* A quote's bit is set in `in` from the quote up to the byte before its closing quote */
+            const u64 in = self->quote ? __prefix_xor(__eq64(blk, self->quote) & valid) ^ inside : 0;
+            inside = 0 - (in >> 63);
+
+            for(u64 s = (__eq64(blk, self->delim) | __eq64(blk, '\n')) & valid & ~in; s; s &= s - 1) {
+                const char * const q = p + __builtin_ctzll(s);
+                if(*q != '\n') {
+                    if(!__push(self, field, q)) return -1;
+                    field = q + 1;
+                    continue;
+                }
+
+                if(!__push(self, field, q > field && q[-1] == '\r' ? q - 1 : q)) return -1;
+                atlib_bufread_consume(br, q + 1 - start);
+                return 1;
+            }
+        }
+
+        /* The stream ended without a final newline; the rest of it is the last record */
+        if(last) {
+            if(!__push(self, field, end > field && end[-1] == '\r' ? end - 1 : end)) return -1;
+            atlib_bufread_consume(br, end - start);
+            return 1;
+        }
+
+        /* The record spans a refill, which may move it, so it is scanned again from its start */
+        if(__atlib_bufread_more(br) == 0) last = 1;
+    }
+}
+
+usize atlib_bufcsv_unquote(const bufcsv_t * restrict self, bufview_t field, char * restrict dst) {
+    atlib_compassert(self);
+    atlib_compassert(dst);
+
+    usize n = 0;
+    for(usize i = 0; i < field.len; i++) {
+        dst[n++] = field.ptr[i];
+        if(self->quote && field.ptr[i] == self->quote && i + 1 < field.len && field.ptr[i + 1] == self->quote) i++;
+    }
+
+    return n;
+}
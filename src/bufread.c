@@ -1,43 +1,607 @@
+#define _GNU_SOURCE
+/* Emits the exported definitions of the inline readers declared in bufread.h */
+#define __ATLIB_BUFREAD_INLINE_EXPORT
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "Atlib/io/bufread.h"
 #include "Atlib/error.h"
 #include "Atlib/io/bufread_flags.h"
 
-#define UBYTE_MASK 0x00ff
+/* The access pattern hints, see bufread_flags.h */
+#define __HINTS (BUFREAD_SEQUENTIAL | BUFREAD_RANDOM | BUFREAD_NOREUSE | BUFREAD_WILLNEED)
 
+/* How much a BUFREAD_NOREUSE stream reads before releasing the cached pages behind it */
+#define __DROP_STEP ((usize)1 << 20)
+
+/* Flags of streams whose whole source is already in view, so that nothing is ever read or copied */
+#define __IN_VIEW (BUFREAD_MMAP | BUFREAD_MEM)
+
+/* Flags only AtLib sets, masked out of those passed when opening a stream */
+#define __PRIVATE (BUFREAD_MEM | BUFREAD_BUF_ALLOC | BUFREAD_EOF | BUFREAD_ERR)
+
+static inline i32 __is_open(const bufread_t * self) {
+    return self->fh != nullptr || self->fd >= 0 || self->flags & BUFREAD_MEM;
+}
+
+/* Releases the page cache behind the buffer, once enough of it has built up */
+static void __drop_behind(bufread_t * self) {
+    const usize behind = self->off > self->cap ? self->off - self->cap : 0;
+
+    /* A seek backwards restarts the count */
+    if(self->drop > behind) self->drop = behind;
+    if(behind - self->drop < __DROP_STEP) return;
+
+    (void)posix_fadvise(self->fd, self->drop, behind - self->drop, POSIX_FADV_DONTNEED);
+    self->drop = behind;
+}
+
+/* The fewest bytes a refill from the cache stops at, when it reaches the end of a block */
+#define __CACHE_MIN 64
+
+/* One cached block of the file, starting at the aligned position `off` */
+struct __bufread_block {
+    usize off;
+    usize len;                      /* Less than the block size only at the end of the file */
+    u64 used;                       /* When the block was last used, or 0 while it is empty */
+    char * data;
+};
+
+/* The most recently used blocks of the file, see atlib_bufread_cache */
+struct __bufread_cache {
+    usize block;
+    usize n;
+    u64 tick;
+    usize end;                      /* The end of the file, once a block has reached it */
+    char * mem;
+    struct __bufread_block blocks[];
+};
+
+/* Finds the block starting at `off`, reading it over the least recently used one if it is not cached; `nullptr` on error or past the end */
+static struct __bufread_block * __cache_get(bufread_t * self, usize off) {
+    struct __bufread_cache * c = self->cache;
+    struct __bufread_block * b = &c->blocks[0];
+
+    for(usize i = 0; i < c->n; i++) {
+        struct __bufread_block * const e = &c->blocks[i];
+        if(e->used && e->off == off) {
+            e->used = ++c->tick;
+            return e;
+        }
+        if(e->used < b->used) b = e;
+    }
+
+    /* There is no block past the end of the file, and none is evicted looking for one */
+    if(off >= c->end) {
+        self->flags |= BUFREAD_EOF;
+        return nullptr;
+    }
+
+    usize len = 0;
+    while(len < c->block) {
+        const isize r = pread(self->fd, b->data + len, c->block - len, off + len);
+        if(r < 0 && errno == EINTR) continue;
+        if(r < 0) {
+            self->flags |= BUFREAD_ERR;
+            b->used = 0;
+            return nullptr;
+        }
+        if(r == 0) break;
+        len += r;
+    }
+
+    /* The end of the file has been found; if nothing was read, the block it would replace stays cached */
+    if(len < c->block) c->end = off + len;
+    if(len == 0) {
+        self->flags |= BUFREAD_EOF;
+        return nullptr;
+    }
+
+    b->off = off;
+    b->len = len;
+    b->used = ++c->tick;
+    return b;
+}
+
+/* Copies at most `n` bytes from the file position `off` out of the cached blocks; returns bytes copied */
+static usize __cache_read(bufread_t * self, char * dst, usize n) {
+    const usize block = self->cache->block;
+    usize r = 0;
+
+    /* Stop at the end of a block, so a lookup does not evict a block for bytes nobody asked for,
+       unless too little was copied to hold a fixed-width value */
+    while(r < n && r < __CACHE_MIN) {
+        const usize at = self->off + r;
+        const struct __bufread_block * const b = __cache_get(self, at - at % block);
+        if(b == NULL) break;
+
+        const usize skip = at % block;
+        if(b->len <= skip) {
+            self->flags |= BUFREAD_EOF;
+            break;
+        }
+
+        const usize k = b->len - skip < n - r ? b->len - skip : n - r;
+        memcpy(dst + r, b->data + skip, k);
+        r += k;
+
+        /* A short block ends the file; looking up the next one would only evict a block for nothing */
+        if(b->len < block && skip + k == b->len) {
+            self->flags |= BUFREAD_EOF;
+            break;
+        }
+    }
+
+    return r;
+}
+
+/* Reads at most `n` bytes from the underlying file into `dst`, updating the stream state */
+static isize __source(bufread_t * self, char * dst, usize n) {
+    isize r;
+
+    /* A ranged stream ends at its limit, whatever follows in the file */
+    if(n > self->lim - self->off) n = self->lim - self->off;
+    if(n == 0) {
+        self->flags |= BUFREAD_EOF;
+        return 0;
+    }
+
+    if(self->cache) r = __cache_read(self, dst, n);
+    else if(self->flags & BUFREAD_FD) {
+        do { r = read(self->fd, dst, n); } while(r < 0 && errno == EINTR);
+        if(r < 0) {
+            self->flags |= BUFREAD_ERR;
+            return 0;
+        }
+        if(r == 0) self->flags |= BUFREAD_EOF;
+    }
+    else if((usize)(r = fread(dst, 1, n, self->fh)) < n) {
+        if(ferror(self->fh)) self->flags |= BUFREAD_ERR;
+        if(feof(self->fh)) self->flags |= BUFREAD_EOF;
+    }
+
+    self->off += r;
+    if(self->flags & BUFREAD_NOREUSE) __drop_behind(self);
+    return r;
+}
+
+/* States of the read-ahead helper, guarded by `lock` */
+#define __AHEAD_READY   0   /* `back` holds a finished read; the helper is idle */
+#define __AHEAD_WANT    1   /* `back` has been drained and should be refilled */
+#define __AHEAD_BUSY    2   /* The helper is reading into `back` without the lock, or a read is queued on `ring` */
+#define __AHEAD_QUIT    3   /* The helper should exit */
+
+/* Room kept in front of each background read, so unread bytes can be prepended rather than the read copied */
+#define __AHEAD_SLACK   64
+
+/* Background read-ahead: a helper thread, or a read queued on `ring`, fills `back` while the reader works through its own buffer */
+struct __bufread_ahead {
+    uring_t * ring;
+    struct __atlib_uring_op op;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    FILE * fh;
+    i32 fd;
+    i32 state;
+    char * back;                    /* Read into from `back + __AHEAD_SLACK` */
+    usize cap;
+    usize len;
+    usize pos;
+    u32 flags;
+    char * lo;                      /* The first byte of the stream's buffer that holds file data */
+};
+
+/* Publishes a finished read of `r` bytes into `back`; `lock` must be held */
+static inline void __ahead_done(struct __bufread_ahead * a, usize r, u32 f) {
+    a->len = r;
+    a->pos = 0;
+    a->flags = f;
+    a->state = __AHEAD_READY;
+    pthread_cond_broadcast(&a->cond);
+}
+
+static void * __ahead_run(void * arg) {
+    struct __bufread_ahead * a = arg;
+
+    pthread_mutex_lock(&a->lock);
+    for(;;) {
+        while(a->state == __AHEAD_READY) pthread_cond_wait(&a->cond, &a->lock);
+        if(a->state == __AHEAD_QUIT) break;
+
+        a->state = __AHEAD_BUSY;
+        char * const dst = a->back + __AHEAD_SLACK;
+        const usize n = a->cap - __AHEAD_SLACK;
+        pthread_mutex_unlock(&a->lock);
+
+        isize r;
+        u32 f = 0;
+        if(a->fh == nullptr) {
+            do { r = read(a->fd, dst, n); } while(r < 0 && errno == EINTR);
+            if(r < 0) {
+                f |= BUFREAD_ERR;
+                r = 0;
+            }
+            else if(r == 0) f |= BUFREAD_EOF;
+        }
+        else if((usize)(r = fread(dst, 1, n, a->fh)) < n) {
+            if(ferror(a->fh)) f |= BUFREAD_ERR;
+            if(feof(a->fh)) f |= BUFREAD_EOF;
+        }
+
+        pthread_mutex_lock(&a->lock);
+        __ahead_done(a, r, f);
+    }
+    pthread_mutex_unlock(&a->lock);
+
+    return nullptr;
+}
+
+/* Blocks until the helper is idle, or the queued read has completed; `lock` must be held */
+static inline void __ahead_wait(struct __bufread_ahead * a) {
+    if(a->ring) {
+        if(a->state != __AHEAD_BUSY) return;
+
+        __atlib_uring_wait(a->ring, &a->op);
+        const i32 r = a->op.res;
+        __ahead_done(a, r < 0 ? 0 : r, r < 0 ? BUFREAD_ERR : r == 0 ? BUFREAD_EOF : 0);
+        return;
+    }
+    while(a->state != __AHEAD_READY) pthread_cond_wait(&a->cond, &a->lock);
+}
+
+/* Hands `back` to the helper, or queues a read on the ring, to refill; `lock` must be held */
+static inline void __ahead_kick(struct __bufread_ahead * a) {
+    a->len = 0;
+    a->pos = 0;
+    a->flags = 0;
+
+    if(a->ring) {
+        if(__atlib_uring_queue(a->ring, &a->op, 0, a->fd, a->back + __AHEAD_SLACK, a->cap - __AHEAD_SLACK)) a->state = __AHEAD_BUSY;
+        else __ahead_done(a, 0, BUFREAD_ERR);
+        return;
+    }
+    a->state = __AHEAD_WANT;
+    pthread_cond_broadcast(&a->cond);
+}
+
+/* Starts the helper thread, or the first read on `ring`, moving the stream onto a buffer AtLib owns so the two can be swapped */
+static i32 __ahead_start(bufread_t * self, uring_t * ring) {
+    if(self->cap < 2 * __AHEAD_SLACK) return 0;
+
+    struct __bufread_ahead * a = malloc(sizeof(*a));
+    if(a == NULL) return 0;
+
+    char * front = self->base;
+    if(~self->flags & BUFREAD_BUF_ALLOC && (front = malloc(self->cap)) == NULL) goto front_err;
+    if((a->back = malloc(self->cap)) == NULL) goto back_err;
+
+    a->fh = self->flags & BUFREAD_FD ? nullptr : self->fh;
+    a->fd = self->fd;
+    a->cap = self->cap;
+    a->len = 0;
+    a->pos = 0;
+    a->flags = 0;
+    a->ring = ring;
+    a->state = __AHEAD_READY;
+    pthread_mutex_init(&a->lock, NULL);
+    pthread_cond_init(&a->cond, NULL);
+    if(ring) __ahead_kick(a);
+    else {
+        a->state = __AHEAD_WANT;
+        if(pthread_create(&a->thread, NULL, __ahead_run, a)) goto thread_err;
+    }
+
+    if(front != self->base) {
+        memcpy(front, self->next, self->to_read);
+        self->base = front;
+        self->next = front;
+        self->flags |= BUFREAD_BUF_ALLOC;
+    }
+    a->lo = self->base;
+    self->ahead = a;
+    return 1;
+
+thread_err:
+    pthread_cond_destroy(&a->cond);
+    pthread_mutex_destroy(&a->lock);
+    free(a->back);
+back_err:
+    if(front != self->base) free(front);
+front_err:
+    free(a);
+    return 0;
+}
+
+static void __ahead_stop(bufread_t * self) {
+    struct __bufread_ahead * a = self->ahead;
+
+    pthread_mutex_lock(&a->lock);
+    __ahead_wait(a);
+    a->state = __AHEAD_QUIT;
+    pthread_cond_broadcast(&a->cond);
+    pthread_mutex_unlock(&a->lock);
+    if(a->ring == nullptr) pthread_join(a->thread, NULL);
+
+    pthread_cond_destroy(&a->cond);
+    pthread_mutex_destroy(&a->lock);
+    free(a->back);
+    free(a);
+    self->ahead = nullptr;
+}
+
+/* Refills from the helper's buffer, trading buffers instead of copying whenever the unread bytes fit in front of its data */
+static isize __fill_ahead(bufread_t * self) {
+    struct __bufread_ahead * a = self->ahead;
+    i32 tail;
+
+    pthread_mutex_lock(&a->lock);
+    do {
+        __ahead_wait(a);
+        self->flags |= a->flags;
+
+        const usize i = self->to_read;
+        char * const data = a->back + __AHEAD_SLACK + a->pos;
+        usize k = a->len - a->pos;
+        tail = a->pos != 0;
+
+        if(i <= __AHEAD_SLACK + a->pos) {
+            char * const t = a->back;
+            memcpy(data - i, self->next, i);
+            a->back = self->base;
+            self->base = t;
+            self->next = data - i;
+        }
+        else {
+            if(k > self->cap - i) k = self->cap - i;
+            memmove(self->base, self->next, i);
+            memcpy(self->base + i, data, k);
+            self->next = self->base;
+        }
+        if(k > self->lim - self->off) {
+            k = self->lim - self->off;
+            self->flags |= BUFREAD_EOF;
+        }
+        a->lo = self->next;
+        a->pos += k;
+        if(a->pos == a->len) __ahead_kick(a);
+
+        self->off += k;
+        self->to_read = i + k;
+
+    /* A leftover tail is not a fresh read, so it may be too short for a fixed-width value */
+    } while(tail && self->to_read < __AHEAD_SLACK && !(self->flags & (BUFREAD_EOF | BUFREAD_ERR)));
+    pthread_mutex_unlock(&a->lock);
+
+    if(self->flags & BUFREAD_NOREUSE) __drop_behind(self);
+    return self->to_read;
+}
+
+/* Moves the unread bytes to the front of the buffer and fills the rest; returns bytes available */
 static isize __fill(bufread_t * self) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
+    atlib_compassert(__is_open(self));
+
+    /* The whole source is already in view, there is nothing left to fill */
+    if(self->flags & __IN_VIEW) {
+        self->flags |= BUFREAD_EOF;
+        return self->to_read;
+    }
+
+    /* The helper starts on the first refill, so the buffer can still be replaced after opening */
+    if(self->flags & BUFREAD_READAHEAD) {
+        if(self->ahead || __ahead_start(self, nullptr)) return __fill_ahead(self);
+        self->flags &= ~BUFREAD_READAHEAD;
+    }
+
+    const isize i = self->to_read;
+    memmove(self->base, self->next, i);
+    self->next = self->base;
+
+    self->to_read = i + __source(self, self->base + i, self->cap - i);
+    return self->to_read;
+}
+
+/* Whether a request for `n` more bytes, with the buffer drained, should skip the buffer */
+static inline i32 __can_bypass(const bufread_t * self, usize n) {
+    return self->to_read == 0 && n >= self->cap && !(self->flags & __IN_VIEW) && self->ahead == nullptr;
+}
 
-    i32 i = self->to_read;
-    //if(ferror(self->fh) || feof(self->fh)) return 0; // Don't read on errors
+/* Reads `n` bytes straight into `dst` in as few calls as possible; returns bytes read */
+static usize __bypass(bufread_t * self, char * dst, usize n) {
+    atlib_compassert(self->to_read == 0);
 
-    memmove(self->buf, self->next, i);
+    usize r = 0;
+    isize k;
+    while(r < n && (k = __source(self, dst + r, n - r)) > 0) r += k;
+
+    self->next = self->base;
+    return r;
+}
 
-    self->next = self->buf; // Reset next pointer
-    if(((self->to_read = fread(self->buf + i, 1, __ATLIB_BUFREAD_SIZE - i, self->fh)) < __ATLIB_BUFREAD_SIZE - i 
-                && ferror(self->fh)) || self->to_read == 0) { 
-        return 0; 
+/* Replaces the buffer with a larger allocation, keeping the unread bytes */
+static i32 __grow(bufread_t * self, usize cap) {
+    /* The two buffers are swapped, so the helper's must grow as well */
+    if(self->ahead) {
+        struct __bufread_ahead * a = self->ahead;
+
+        pthread_mutex_lock(&a->lock);
+        __ahead_wait(a);
+        char * const back = realloc(a->back, cap);
+        if(back) {
+            a->back = back;
+            a->cap = cap;
+        }
+        pthread_mutex_unlock(&a->lock);
+        if(back == NULL) return 0;
     }
-    self->to_read += i;   // Add existing bytes to what was read
-    return self->to_read; // Return bytes to be read
+
+    char * mem = malloc(cap);
+    if(mem == NULL) return 0;
+
+    memcpy(mem, self->next, self->to_read);
+    if(self->flags & BUFREAD_BUF_ALLOC) free(self->base);
+    self->flags |= BUFREAD_BUF_ALLOC;
+
+    self->base = mem;
+    self->cap = cap;
+    self->next = self->base;
+    if(self->ahead) self->ahead->lo = self->base;
+    return 1;
+}
+
+/* Finds the first `c` in [p, end), or nullptr */
+static const char * __scan(const char * p, const char * const end, const char c) {
+#if defined(__AVX2__)
+    const __m256i needle32 = _mm256_set1_epi8(c);
+    for(; end - p >= 32; p += 32) {
+        const u32 m = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)p), needle32));
+        if(m) return p + __builtin_ctz(m);
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i needle = _mm_set1_epi8(c);
+    for(; end - p >= 64; p += 64) {
+        const u64 m = (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), needle))
+            | (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 16)), needle)) << 16
+            | (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 32)), needle)) << 32
+            | (u64)(u16)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 48)), needle)) << 48;
+        if(m) return p + __builtin_ctzll(m);
+    }
+    for(; end - p >= 16; p += 16) {
+        const u32 m = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), needle));
+        if(m) return p + __builtin_ctz(m);
+    }
+#endif
+    for(; p < end; p++) if(*p == c) return p;
+    return nullptr;
+}
+
+static i32 __map(bufread_t * self) {
+    atlib_compassert(self);
+    atlib_compassert(__is_open(self));
+
+    struct stat st;
+    if(self->fd < 0 || fstat(self->fd, &st) || !S_ISREG(st.st_mode) || st.st_size <= 0) return 0;
+
+    void * m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, self->fd, 0);
+    if(m == MAP_FAILED) return 0;
+
+    self->base = m;
+    self->cap = st.st_size;
+    self->next = self->base;
+    self->to_read = self->cap;
+    self->off = self->cap;
+    return 1;
+}
+
+/* Asks the kernel to start reading everything from the stream's position up to its limit */
+static void __prefetch(bufread_t * self) {
+    if(self->flags & BUFREAD_MMAP) {
+        const usize page = sysconf(_SC_PAGESIZE);
+        char * const p = (char *)((usize)self->next & ~(page - 1));
+        (void)madvise(p, self->base + self->off - p, MADV_WILLNEED);
+    }
+    else (void)readahead(self->fd, self->off, self->lim - self->off);
+}
+
+/* Passes the access pattern hints on to the kernel; hints only, so failures are ignored */
+static bufread_t * __advise(bufread_t * self) {
+    u32 f = self->flags;
+
+    /* Without hints, a mapped file is assumed to be read once, front to back */
+    if(f & BUFREAD_MMAP) {
+        if(!(f & __HINTS)) f |= BUFREAD_SEQUENTIAL | BUFREAD_WILLNEED;
+        if(f & BUFREAD_SEQUENTIAL) (void)madvise(self->base, self->cap, MADV_SEQUENTIAL);
+        if(f & BUFREAD_RANDOM) (void)madvise(self->base, self->cap, MADV_RANDOM);
+    }
+    else {
+        if(f & BUFREAD_SEQUENTIAL) (void)posix_fadvise(self->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        if(f & BUFREAD_RANDOM) (void)posix_fadvise(self->fd, 0, 0, POSIX_FADV_RANDOM);
+    }
+    if(f & BUFREAD_NOREUSE) (void)posix_fadvise(self->fd, 0, 0, POSIX_FADV_NOREUSE);
+    if(f & BUFREAD_WILLNEED) __prefetch(self);
+
+    return self;
+}
+
+/* Shared initialization once `fh` and `fd` have been set */
+static bufread_t * __init(bufread_t * self, u32 br_flags) {
+    self->flags = br_flags == 0 ? BUFREAD_FLAG_DEFAULT : br_flags & ~(BUFREAD_EOF | BUFREAD_ERR | BUFREAD_BUF_ALLOC);
+    self->to_read = 0;
+    self->base = self->buf;
+    self->cap = __ATLIB_BUFREAD_SIZE;
+    self->next = self->base;
+    self->off = 0;
+    self->lim = (usize)-1;
+    self->drop = 0;
+    self->ahead = nullptr;
+    self->cache = nullptr;
+
+    if(!(self->flags & (BUFREAD_READ_BE | BUFREAD_READ_LE))) self->flags |= BUFREAD_READ_NATIVE;
+    if(self->flags & BUFREAD_MMAP && !__map(self)) self->flags &= ~BUFREAD_MMAP;
+
+    return self;
 }
 
 bufread_t * atlib_bufread_open(bufread_t * restrict self, const char * restrict file_path, u32 br_flags) {
     atlib_compassert(self);
     atlib_compassert(file_path);
 
+    br_flags &= ~(__PRIVATE | BUFREAD_FH_ATTACH);
+
+    if(br_flags & BUFREAD_FD) {
+        if((self->fd = open(file_path, O_RDONLY | O_CLOEXEC)) < 0) return NULL;
+        self->fh = nullptr;
+        return __advise(__init(self, br_flags));
+    }
+
     FILE * fh = fopen(file_path, "r");
     if(fh == NULL) {
         return NULL;
     }
     self->fh = fh;
-    self->flags = br_flags == 0 ? BUFREAD_FLAG_DEFAULT : br_flags;
-    self->to_read = 0;
-    self->next = self->buf;
+    self->fd = fileno(fh);
+    return __advise(__init(self, br_flags));
+}
+
+bufread_t * atlib_bufread_open_range(bufread_t * restrict self, const char * restrict file_path, bufrange_t range, u32 br_flags) {
+    atlib_compassert(self);
+    atlib_compassert(file_path);
+    atlib_compassert(range.start <= range.end);
+
+    /* Prefetch only the range, once it is known */
+    if(atlib_bufread_open(self, file_path, br_flags & ~BUFREAD_WILLNEED) == NULL) return NULL;
+    self->flags |= br_flags & BUFREAD_WILLNEED;
+
+    /* Trim the mapping's window to the range; the mapping itself stays whole */
+    if(self->flags & BUFREAD_MMAP) {
+        self->lim = range.end < self->cap ? range.end : self->cap;
+        if(range.start > self->lim) range.start = self->lim;
+        self->off = self->lim;
+        self->next = self->base + range.start;
+        self->to_read = self->lim - range.start;
+    }
+    else {
+        self->lim = range.end;
+        atlib_bufread_seek(self, range.start);
+        self->drop = self->off;
+    }
 
+    if(self->flags & BUFREAD_WILLNEED) __prefetch(self);
     return self;
 }
 
@@ -45,19 +609,145 @@ bufread_t * atlib_bufread_fopen(bufread_t * restrict self, FILE * restrict file)
     atlib_compassert(self);
 
     self->fh = file;
-    self->flags = BUFREAD_FLAG_DEFAULT | BUFREAD_FH_ATTACH;
-    self->to_read = 0;
-    self->next = self->buf;
+    self->fd = fileno(file);
+    __init(self, BUFREAD_FLAG_DEFAULT | BUFREAD_FH_ATTACH);
+
+    const long pos = ftell(file);
+    self->off = pos < 0 ? 0 : pos;
+    return self;
+}
+
+bufread_t * atlib_bufread_fdopen(bufread_t * self, i32 fd, u32 br_flags) {
+    atlib_compassert(self);
+    atlib_compassert(fd >= 0);
+
+    self->fh = nullptr;
+    self->fd = fd;
+    __init(self, (br_flags & ~__PRIVATE) | BUFREAD_FD | BUFREAD_FH_ATTACH);
+
+    if(~self->flags & BUFREAD_MMAP) {
+        const off_t pos = lseek(fd, 0, SEEK_CUR);
+        self->off = pos < 0 ? 0 : pos;
+        self->drop = self->off;
+    }
+    return __advise(self);
+}
+
+bufread_t * atlib_bufread_memopen(bufread_t * restrict self, const void * restrict mem, usize len, u32 br_flags) {
+    atlib_compassert(self);
+    atlib_compassert(mem);
+
+    self->fh = nullptr;
+    self->fd = -1;
+    __init(self, (br_flags & (BUFREAD_READ_BE | BUFREAD_READ_LE)) | BUFREAD_MEM);
+
+    /* Like a mapping, the memory is walked in place and never written to */
+    self->base = (char *)mem;
+    self->cap = len;
+    self->next = self->base;
+    self->to_read = len;
+    self->off = len;
+    return self;
+}
+
+bufread_t * atlib_bufread_setbuf(bufread_t * self, void * buf, usize cap) {
+    atlib_compassert(self);
+    atlib_compassert(cap > 0);
+
+    /* The mapping, or memory, already serves every read */
+    if(self->flags & __IN_VIEW) return self;
+    if(self->ahead || self->to_read > (isize)cap) return NULL;
+
+    char * mem = buf;
+    if(mem == NULL && (mem = malloc(cap)) == NULL) return NULL;
+
+    memmove(mem, self->next, self->to_read);
+    if(self->flags & BUFREAD_BUF_ALLOC) free(self->base);
+
+    if(buf == NULL) self->flags |= BUFREAD_BUF_ALLOC;
+    else self->flags &= ~BUFREAD_BUF_ALLOC;
+
+    self->base = mem;
+    self->cap = cap;
+    self->next = self->base;
+    return self;
+}
+
+bufread_t * atlib_bufread_uring(bufread_t * self, uring_t * ring) {
+    atlib_compassert(self);
+    atlib_compassert(__is_open(self));
+    atlib_compassert(ring);
+
+    /* Reads are queued against the descriptor, so a FILE's own buffer would be skipped */
+    if(~self->flags & BUFREAD_FD || self->flags & __IN_VIEW || self->ahead || self->cache) return NULL;
+    if(!__ahead_start(self, ring)) return NULL;
+
+    self->flags |= BUFREAD_READAHEAD;
+    return self;
+}
+
+bufread_t * atlib_bufread_cache(bufread_t * self, usize n, usize block) {
+    atlib_compassert(self);
+    atlib_compassert(__is_open(self));
+    atlib_compassert(n > 0);
+
+    /* The mapping, or memory, already serves every read */
+    if(self->flags & __IN_VIEW) return self;
+    if(self->flags & BUFREAD_READAHEAD || self->cache) return NULL;
+
+    /* Blocks are read at their own offset, which pipes and terminals do not support */
+    if(lseek(self->fd, 0, SEEK_CUR) < 0) return NULL;
+    if(block == 0) block = self->cap;
+
+    struct __bufread_cache * c = malloc(sizeof(*c) + n * sizeof(c->blocks[0]));
+    if(c == NULL) return NULL;
+    if((c->mem = malloc(n * block)) == NULL) {
+        free(c);
+        return NULL;
+    }
+
+    c->block = block;
+    c->n = n;
+    c->tick = 0;
+    c->end = (usize)-1;
+    for(usize i = 0; i < n; i++) {
+        c->blocks[i] = (struct __bufread_block){ .data = c->mem + i * block };
+    }
+
+    self->cache = c;
     return self;
 }
 
 void atlib_bufread_close(bufread_t * self) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
+    atlib_compassert(__is_open(self));
+
+    if(self->ahead) __ahead_stop(self);
+    if(self->cache) {
+        free(self->cache->mem);
+        free(self->cache);
+        self->cache = nullptr;
+    }
+
+    /* Release whatever is left behind the reader */
+    if(self->flags & BUFREAD_NOREUSE && !(self->flags & __IN_VIEW) && self->off > self->drop) {
+        (void)posix_fadvise(self->fd, self->drop, self->off - self->drop, POSIX_FADV_DONTNEED);
+    }
+
+    if(self->flags & BUFREAD_MMAP) munmap(self->base, self->cap);
+    else if(self->flags & BUFREAD_BUF_ALLOC) free(self->base);
+    self->base = nullptr;
+    self->cap = 0;
 
     self->next = nullptr;
     self->to_read = 0;
-    if(~self->flags & BUFREAD_FH_ATTACH) fclose(self->fh);
+    if(!(self->flags & (BUFREAD_FH_ATTACH | BUFREAD_MEM))) {
+        if(self->flags & BUFREAD_FD) close(self->fd);
+        else fclose(self->fh);
+    }
+    self->fh = nullptr;
+    self->fd = -1;
+    self->flags &= ~BUFREAD_MEM;
     memset(self->buf, 0, sizeof(self->buf));
 }
 
@@ -66,17 +756,73 @@ isize atlib_bufread_read_nline(bufread_t * restrict self, void * restrict b, u32
     atlib_compassert(b);
 
     char * buf = (char *)b;
-    const u32 r = n;
-    char c = 1;
+    usize r = 0;
+
+    while(r < n && (self->to_read > 0 || __fill(self) > 0)) {
+        usize len = (usize)self->to_read < n - r ? (usize)self->to_read : n - r;
+        const char * nl = __scan(self->next, self->next + len, '\n');
+        if(nl) len = nl - self->next + 1;
+
+        memcpy(&buf[r], self->next, len);
+        self->next += len;
+        self->to_read -= len;
+        r += len;
+        if(nl) break;
+    }
+    if(r) buf[r - 1] = 0;
 
-    while(n && c != '\n' && (self->to_read > 0 || __fill(self) > 0)) {
-        c = *buf++ = *self->next++;
-        self->to_read--;
-        n--;
+    return r;
+}
+
+i32 atlib_bufread_next_line(bufread_t * restrict self, bufview_t * restrict line) {
+    return atlib_bufread_next_delim(self, "\n", 1, line);
+}
+
+isize __atlib_bufread_more(bufread_t * self) {
+    atlib_compassert(self);
+    atlib_compassert(__is_open(self));
+
+    /* Only grow when the unread bytes fill the whole buffer */
+    if(!(self->flags & __IN_VIEW) && (usize)self->to_read == self->cap && !__grow(self, self->cap * 2)) return 0;
+
+    const isize had = self->to_read;
+    return __fill(self) - had;
+}
+
+i32 atlib_bufread_next_delim(bufread_t * restrict self, const char * restrict delim, usize dlen, bufview_t * restrict rec) {
+    atlib_compassert(self);
+    atlib_compassert(__is_open(self));
+    atlib_compassert(delim);
+    atlib_compassert(dlen > 0);
+
+    const char last = delim[dlen - 1];
+    usize scanned = 0;
+
+    for(;;) {
+        /* Search for the final byte of the delimiter, then confirm the bytes before it */
+        const char * const end = self->next + self->to_read;
+        for(const char * p = __scan(self->next + scanned, end, last); p; p = __scan(p + 1, end, last)) {
+            const usize len = p + 1 - self->next;
+            if(len < dlen || memcmp(p + 1 - dlen, delim, dlen - 1)) continue;
+
+            *rec = (bufview_t){ .ptr = self->next, .len = len - dlen };
+            self->next += len;
+            self->to_read -= len;
+            return 1;
+        }
+        scanned = self->to_read;
+
+        /* The record spans a refill */
+        if(__atlib_bufread_more(self) == 0) break;
     }
-    *(--buf) = 0;
 
-    return r - n;
+    /* The final record is not followed by a delimiter */
+    if(self->to_read == 0) return 0;
+
+    *rec = (bufview_t){ .ptr = self->next, .len = self->to_read };
+    self->next += self->to_read;
+    self->to_read = 0;
+    return 1;
 }
 
 u32 atlib_bufread_read(bufread_t * const restrict self, void * const restrict b, const u32 blk, const u32 n) {
@@ -85,14 +831,22 @@ u32 atlib_bufread_read(bufread_t * const restrict self, void * const restrict b,
     atlib_compassert((usize)b < (usize)self || (usize)b >= (usize)self + sizeof(bufread_t));
 
     char * const buf = (char *)b;
-    const isize rb = blk * n;
-    isize rem_bytes = blk * n;
+    const isize rb = (isize)blk * n;
+    isize rem_bytes = rb;
 
     // While there is more bytes requested than in buffer...
-    while(rem_bytes > __ATLIB_BUFREAD_SIZE && __fill(self)) {
-        memcpy(&buf[rb - rem_bytes], self->buf, __ATLIB_BUFREAD_SIZE);
-        rem_bytes -= __ATLIB_BUFREAD_SIZE;
+    while(rem_bytes > self->to_read) {
+        memcpy(&buf[rb - rem_bytes], self->next, self->to_read);
+        rem_bytes -= self->to_read;
+        self->next += self->to_read;
         self->to_read = 0;
+
+        // ...large requests skip the buffer and go straight into `buf`
+        if(__can_bypass(self, rem_bytes)) {
+            rem_bytes -= __bypass(self, &buf[rb - rem_bytes], rem_bytes);
+            break;
+        }
+        if(__fill(self) == 0) break;
     }
 
     if(rem_bytes <= self->to_read || rem_bytes <= __fill(self)) {
@@ -103,442 +857,625 @@ u32 atlib_bufread_read(bufread_t * const restrict self, void * const restrict b,
     }
 
     return n - (rem_bytes / blk);
-
-    /*
-    char * const buf = (char *)b;
-    const usize blks_per_buf = __ATLIB_BUFREAD_SIZE / blk;
-    const usize blks_per_buf_bytes = blks_per_buf * blk;
-    const usize limit = blk * n;
-    const usize r = n;
-
-    // While there are enough blks to save that take about whole buffer
-    while(n >= blks_per_buf && ((usize)self->to_read >= blks_per_buf_bytes || __fill(self) >= blks_per_buf_bytes)) {
-        memcpy(&buf[limit - (n * blk)], self->next, blks_per_buf_bytes);
-        self->to_read -= blks_per_buf_bytes;
-        n -= blks_per_buf;
-        __fill(self);
-    }
-
-    const usize rem = blk * n;
-    if(((usize)self->to_read >= rem || __fill(self) >= rem)) {
-        memcpy(&buf[limit - rem], self->buf, rem);
-        self->to_read -= rem;
-        self->next += rem;
-        n = 0;
-    }
-       
-    return r - n;
-    */
 }
 
 isize atlib_bufread_readn(bufread_t * restrict self, void * restrict b, u32 n) {
+    return atlib_bufread_read(self, b, 1, n);
+}
+
+bufview_t atlib_bufread_peek(bufread_t * self, usize n) {
     atlib_compassert(self);
-    atlib_compassert(b);
+    atlib_compassert(__is_open(self));
 
-    const isize r = n;
-    char * buf = (char *)b;
+    if(n > self->cap) n = self->cap;
 
-    if(n <= self->to_read || n <= __fill(self)) {
-        memcpy(b, self->next, n);
-        self->to_read -= n;
-        self->next += n;
-        return n;
+    /* Only compact and refill when the window is not already buffered */
+    while(self->to_read < (isize)n) {
+        const isize had = self->to_read;
+        if(__fill(self) == had) break;
     }
 
-    do {
-        memcpy(&buf[r - n], self->next, self->to_read);
-        n -= self->to_read;
-        self->to_read = 0;
-    } while(__fill(self) && self->to_read < n);
+    return (bufview_t){ .ptr = self->next, .len = (usize)self->to_read < n ? (usize)self->to_read : n };
+}
 
-    // Only fails if __fill fails
-    if(self->to_read >= n) {
-        memcpy(&buf[r - n], self->next, n);
-        self->to_read -= n;
-        self->next += n;
-        n = 0;
-    }
-    return r - n;
+void atlib_bufread_consume(bufread_t * self, usize n) {
+    atlib_compassert(self);
+    atlib_compassert(n <= (usize)self->to_read);
 
-    //Legacy func that does works, in case rework fails down the line
-    //while(n && (self->to_read > 0 || __fill(self) > 0)) {
-    //    *buf++ = *self->next++;
-    //    self->to_read--;
-    //    n--;
-    //}
+    self->next += n;
+    self->to_read -= n;
+}
 
-    return r - n;
+isize __atlib_bufread_fill(bufread_t * self) {
+    return __fill(self);
 }
 
-u8 atlib_bufread_read_u8(bufread_t * self) {
+/* Whether a value stored in this order must be swapped to be read on the host */
+#define __SWAP_BE (ATLIB_ENDIAN != ATLIB_BIG_ENDIAN)
+#define __SWAP_LE (ATLIB_ENDIAN != ATLIB_LITTLE_ENDIAN)
+
+/* Copies `n` values of `size` bytes into `dst`, swapping each one if asked to */
+static usize __read_array(bufread_t * self, void * dst, usize n, usize size, i32 swap) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
+    atlib_compassert(__is_open(self));
+    atlib_compassert(dst);
+
+    char * out = dst;
+    usize r = 0;
+
+    while(r < n && ((usize)self->to_read >= size || (usize)__fill(self) >= size)) {
+        usize k = self->to_read / size;
+        if(k > n - r) k = n - r;
+
+        if(!swap) memcpy(out, self->next, k * size);
+        else if(size == sizeof(u16)) atlib_bswap16_array(out, self->next, k);
+        else if(size == sizeof(u32)) atlib_bswap32_array(out, self->next, k);
+        else atlib_bswap64_array(out, self->next, k);
+
+        self->next += k * size;
+        self->to_read -= k * size;
+        out += k * size;
+        r += k;
+
+        /* Read large remainders straight into `dst`, and swap them in place */
+        if(__can_bypass(self, (n - r) * size)) {
+            const usize got = __bypass(self, out, (n - r) * size);
+            k = got / size;
+
+            if(swap) {
+                if(size == sizeof(u16)) atlib_bswap16_array(out, out, k);
+                else if(size == sizeof(u32)) atlib_bswap32_array(out, out, k);
+                else atlib_bswap64_array(out, out, k);
+            }
+
+            /* A trailing partial value goes back into the buffer */
+            memcpy(self->base, out + k * size, got - k * size);
+            self->to_read = got - k * size;
+            out += k * size;
+            r += k;
+        }
+    }
 
-    if(self->to_read <= 0 && __fill(self) == 0) return 0;
-    self->to_read--;
-    return *self->next++;
+    return r;
 }
 
-u16 atlib_bufread_read_u16(bufread_t * self) {
-    atlib_compassert(self);
-    atlib_compassert(self->fh);
-    atlib_compassert(self->next);
+usize atlib_bufread_read_u16_array(bufread_t * restrict self, u16 * restrict dst, usize n) {
+    return __read_array(self, dst, n, sizeof(u16), self->flags & BUFREAD_READ_BE ? __SWAP_BE : __SWAP_LE);
+}
 
-    if(self->to_read < 2 && __fill(self) < 2) {
-        return 0;
-    }
-    self->to_read -= 2;
-    u16 ret = *self->next++ & UBYTE_MASK;
+usize atlib_bufread_read_u16_array_be(bufread_t * restrict self, u16 * restrict dst, usize n) {
+    return __read_array(self, dst, n, sizeof(u16), __SWAP_BE);
+}
 
-    if(self->flags & BUFREAD_READ_BE) {
-        return (ret << 8) | (*self->next++ & UBYTE_MASK);
-    }
-    else {
-        return (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-    }
+usize atlib_bufread_read_u16_array_le(bufread_t * restrict self, u16 * restrict dst, usize n) {
+    return __read_array(self, dst, n, sizeof(u16), __SWAP_LE);
 }
 
-u16 atlib_bufread_read_u16_be(bufread_t * self) {
-    atlib_compassert(self);
-    atlib_compassert(self->fh);
-    atlib_compassert(self->next);
+usize atlib_bufread_read_u32_array(bufread_t * restrict self, u32 * restrict dst, usize n) {
+    return __read_array(self, dst, n, sizeof(u32), self->flags & BUFREAD_READ_BE ? __SWAP_BE : __SWAP_LE);
+}
 
-    if(self->to_read < 2 && __fill(self) < 2) {
-        return 0;
-    }
-    self->to_read -= 2;
-    u16 ret = *self->next++ & UBYTE_MASK;
-    return (ret << 8) | (*self->next++ & UBYTE_MASK);
+usize atlib_bufread_read_u32_array_be(bufread_t * restrict self, u32 * restrict dst, usize n) {
+    return __read_array(self, dst, n, sizeof(u32), __SWAP_BE);
 }
 
-u16 atlib_bufread_read_u16_le(bufread_t * self) {
-    atlib_compassert(self);
-    atlib_compassert(self->fh);
-    atlib_compassert(self->next);
+usize atlib_bufread_read_u32_array_le(bufread_t * restrict self, u32 * restrict dst, usize n) {
+    return __read_array(self, dst, n, sizeof(u32), __SWAP_LE);
+}
 
-    if(self->to_read < 2 && __fill(self) < 2) {
-        return 0;
-    }
-    self->to_read -= 2;
-    u16 ret = *self->next++ & UBYTE_MASK;
-    return (ret) | ((*self->next++ & UBYTE_MASK) << 8);
+usize atlib_bufread_read_u64_array(bufread_t * restrict self, u64 * restrict dst, usize n) {
+    return __read_array(self, dst, n, sizeof(u64), self->flags & BUFREAD_READ_BE ? __SWAP_BE : __SWAP_LE);
 }
 
-u32 atlib_bufread_read_u32(bufread_t * self) {
-    atlib_compassert(self);
-    atlib_compassert(self->fh);
-    atlib_compassert(self->next);
+usize atlib_bufread_read_u64_array_be(bufread_t * restrict self, u64 * restrict dst, usize n) {
+    return __read_array(self, dst, n, sizeof(u64), __SWAP_BE);
+}
 
-    if(self->to_read < 4 && __fill(self) < 4) {
-        return 0;
-    }
-    self->to_read -= 4;
-    u32 ret = *self->next++ & UBYTE_MASK;
+usize atlib_bufread_read_u64_array_le(bufread_t * restrict self, u64 * restrict dst, usize n) {
+    return __read_array(self, dst, n, sizeof(u64), __SWAP_LE);
+}
 
-    if(self->flags & BUFREAD_READ_BE) {
-        ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-        ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-        return (ret << 8) | (*self->next++ & UBYTE_MASK);
-    }
-    else {
-        ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-        ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-        return (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-    }
+usize atlib_bufread_read_f32_array(bufread_t * restrict self, f32 * restrict dst, usize n) {
+    return __read_array(self, dst, n, sizeof(f32), self->flags & BUFREAD_READ_BE ? __SWAP_BE : __SWAP_LE);
 }
 
-u32 atlib_bufread_read_u32_be(bufread_t * self) {
-    atlib_compassert(self);
-    atlib_compassert(self->fh);
+usize atlib_bufread_read_f32_array_be(bufread_t * restrict self, f32 * restrict dst, usize n) {
+    return __read_array(self, dst, n, sizeof(f32), __SWAP_BE);
+}
 
-    if(self->to_read < 4 && __fill(self) < 4) return 0;
-    self->to_read -= 4;
-    u32 ret = *self->next++ & UBYTE_MASK;
-    ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-    ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-    return (ret << 8) | (*self->next++ & UBYTE_MASK);
+usize atlib_bufread_read_f32_array_le(bufread_t * restrict self, f32 * restrict dst, usize n) {
+    return __read_array(self, dst, n, sizeof(f32), __SWAP_LE);
 }
 
-u32 atlib_bufread_read_u32_le(bufread_t * self) {
-    atlib_compassert(self);
-    atlib_compassert(self->fh);
+usize atlib_bufread_read_f64_array(bufread_t * restrict self, f64 * restrict dst, usize n) {
+    return __read_array(self, dst, n, sizeof(f64), self->flags & BUFREAD_READ_BE ? __SWAP_BE : __SWAP_LE);
+}
 
-    if(self->to_read < 4 && __fill(self) < 4) return 0;
-    self->to_read -= 4;
-    u32 ret = *self->next++ & UBYTE_MASK;
-    ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-    ret = (ret) | ((*self->next++ & UBYTE_MASK) << 16);
-    return (ret) | ((*self->next++ & UBYTE_MASK) << 24);
+usize atlib_bufread_read_f64_array_be(bufread_t * restrict self, f64 * restrict dst, usize n) {
+    return __read_array(self, dst, n, sizeof(f64), __SWAP_BE);
 }
 
-u64 atlib_bufread_read_u64(bufread_t * self) {
-    atlib_compassert(self);
-    atlib_compassert(self->fh);
-    atlib_compassert(self->next);
+usize atlib_bufread_read_f64_array_le(bufread_t * restrict self, f64 * restrict dst, usize n) {
+    return __read_array(self, dst, n, sizeof(f64), __SWAP_LE);
+}
 
-    if(self->to_read < 8 && __fill(self) < 8) {
-        return 0;
+/* The longest LEB128 encoding of a u64 */
+#define __VARINT_MAX 10
+
+/* Decodes a varint of which at least __VARINT_MAX bytes are in view; returns its length */
+static inline usize __uvarint_fast(const char * p, u64 * v) {
+    u64 w;
+    memcpy(&w, p, sizeof(w));
+#if ATLIB_ENDIAN == ATLIB_BIG_ENDIAN
+    w = __builtin_bswap64(w);
+#endif
+
+    /* The first byte with a clear high bit ends the varint */
+    const u64 stop = ~w & 0x8080808080808080;
+    const usize n = stop ? (__builtin_ctzll(stop) >> 3) + 1 : 8;
+
+    /* Drop the bytes past the end, then pack the 7-bit groups together in three steps */
+    u64 x = (n == 8 ? w : w & (((u64)1 << (n << 3)) - 1)) & 0x7f7f7f7f7f7f7f7f;
+    x = ((x & 0x7f007f007f007f00) >> 1) | (x & 0x007f007f007f007f);
+    x = ((x & 0x3fff00003fff0000) >> 2) | (x & 0x00003fff00003fff);
+    x = ((x & 0x0fffffff00000000) >> 4) | (x & 0x000000000fffffff);
+
+    if(stop) {
+        *v = x;
+        return n;
     }
-    self->to_read -= 8;
-    u64 ret = *self->next++ & UBYTE_MASK;
 
-    if(self->flags & BUFREAD_READ_BE) {
-        ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-        ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-        ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-        ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-        ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-        ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-        return (ret << 8) | (*self->next++ & UBYTE_MASK);
+    /* Only values of 56 bits or more reach past the eighth byte */
+    x |= (u64)(p[8] & 0x7f) << 56;
+    if(~p[8] & 0x80) {
+        *v = x;
+        return 9;
     }
-    else {
-        ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-        ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-        ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-        ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-        ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-        ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-        return (ret) | ((*self->next++ & UBYTE_MASK) << 8);
+    *v = x | (u64)(u8)p[9] << 63;
+    return 10;
+}
+
+/* Decodes a varint a byte at a time across refills; returns 1 once complete, 0 at the end of the stream, -1 if cut short */
+static i32 __uvarint_slow(bufread_t * self, u64 * v) {
+    u64 x = 0;
+
+    for(usize i = 0; i < __VARINT_MAX; i++) {
+        if(self->to_read <= 0 && __fill(self) == 0) {
+            *v = 0;
+            return i ? -1 : 0;
+        }
+        const u8 b = *self->next++;
+        self->to_read--;
+
+        x |= (u64)(b & 0x7f) << (7 * i);
+        if(~b & 0x80) break;
     }
 
-    if(self->flags & BUFREAD_READ_BE) return atlib_bufread_read_u64_be(self);
-    else return atlib_bufread_read_u64_le(self);
+    *v = x;
+    return 1;
 }
 
-u64 atlib_bufread_read_u64_be(bufread_t * self) {
+static inline u64 __unzigzag(const u64 v) {
+    return (v >> 1) ^ (0 - (v & 1));
+}
+
+u64 atlib_bufread_read_uvarint(bufread_t * self) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
+    atlib_compassert(__is_open(self));
 
-    if(self->to_read < 8 && __fill(self) < 8) return 0;
+    u64 v;
+    if(self->to_read >= __VARINT_MAX) {
+        const usize n = __uvarint_fast(self->next, &v);
+        self->next += n;
+        self->to_read -= n;
+    }
+    else (void)__uvarint_slow(self, &v);
 
-    self->to_read -= 8;
-    u64 ret = *self->next++ & UBYTE_MASK;
-    ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-    ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-    ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-    ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-    ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-    ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-    return (ret << 8) | (*self->next++ & UBYTE_MASK);
+    return v;
 }
 
-u64 atlib_bufread_read_u64_le(bufread_t * self) {
+i64 atlib_bufread_read_svarint(bufread_t * self) {
+    return (i64)__unzigzag(atlib_bufread_read_uvarint(self));
+}
+
+usize atlib_bufread_read_uvarint_array(bufread_t * restrict self, u64 * restrict dst, usize n) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
+    atlib_compassert(__is_open(self));
+    atlib_compassert(dst);
+
+    usize i = 0;
+    while(i < n) {
+        /* Stay in the fast path for as long as a whole varint is sure to be in view */
+        const char * p = self->next;
+        const char * const end = p + self->to_read;
+        for(; i < n && end - p >= __VARINT_MAX; i++) p += __uvarint_fast(p, &dst[i]);
+        self->to_read -= p - self->next;
+        self->next = (char *)p;
+
+        if(i < n && __uvarint_slow(self, &dst[i]) <= 0) break;
+        i += i < n;
+    }
 
-    if(self->to_read < 8 && __fill(self) < 8) return 0;
+    return i;
+}
 
-    self->to_read -= 8;
-    u64 ret = *self->next++ & UBYTE_MASK;
-    ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-    ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-    ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-    ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-    ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-    ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-    return (ret) | ((*self->next++ & UBYTE_MASK) << 8);
+usize atlib_bufread_read_svarint_array(bufread_t * restrict self, i64 * restrict dst, usize n) {
+    const usize r = atlib_bufread_read_uvarint_array(self, (u64 *)dst, n);
+    for(usize i = 0; i < r; i++) dst[i] = (i64)__unzigzag((u64)dst[i]);
+    return r;
 }
 
-i8 atlib_bufread_read_i8(bufread_t * self) {
-    atlib_compassert(self);
-    atlib_compassert(self->fh);
+/* Whitespace as isspace(3) sees it in the C locale */
+static inline i32 __is_space(const char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
 
-    if(self->to_read < 1 && __fill(self) < 1) return 0;
-    self->to_read--;
-    return *self->next++;
+static inline i32 __is_digit(const char c) {
+    return (u8)(c - '0') < 10;
 }
 
-i16 atlib_bufread_read_i16(bufread_t * self) {
-    atlib_compassert(self);
-    atlib_compassert(self->fh);
-    atlib_compassert(self->next);
+/* Loads 8 bytes with the first one in the lowest byte, whatever the host */
+static inline u64 __load8(const char * p) {
+    u64 v;
+    memcpy(&v, p, sizeof(v));
+#if ATLIB_ENDIAN == ATLIB_BIG_ENDIAN
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
 
-    if(self->to_read < 2 && __fill(self) < 2) return 0;
-    self->to_read -= 2;
+/* Whether all 8 bytes of a word from __load8 are ASCII digits */
+static inline i32 __all_digits8(const u64 v) {
+    return ((v & 0xF0F0F0F0F0F0F0F0) | (((v + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333;
+}
 
-    i16 ret = *self->next++ & UBYTE_MASK;
-    if(self->flags & BUFREAD_READ_BE) {
-        return (ret << 8) | (*self->next++ & UBYTE_MASK);
+/* Converts the 8 ASCII digits of a word from __load8 with three multiplies instead of eight */
+static inline u64 __eight_digits(u64 v) {
+    v -= 0x3030303030303030;
+    v = v * 10 + (v >> 8);
+    return ((v & 0x000000FF000000FF) * (100 + (1000000ULL << 32))
+        + ((v >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32))) >> 32;
+}
+
+/* Skips whitespace, refilling as needed; returns zero once the stream has no more data */
+static i32 __skip_space(bufread_t * self) {
+    for(;;) {
+        while(self->to_read > 0 && __is_space(*self->next)) {
+            self->next++;
+            self->to_read--;
+        }
+        if(self->to_read > 0) return 1;
+        if(__fill(self) == 0) return 0;
     }
-    else {
-        return (ret) | ((*self->next++ & UBYTE_MASK) << 8);
+}
+
+/* Skips whitespace and an optional sign; returns 1 if a digit follows, 0 at the end of the stream, -1 otherwise */
+static i32 __int_start(bufread_t * self, i32 * neg, const i32 sign) {
+    if(!__skip_space(self)) return 0;
+    if(self->to_read < 2) __fill(self);
+
+    const char * p = self->next;
+    *neg = sign && *p == '-';
+    if(sign && (*p == '-' || *p == '+')) p++;
+    if(p == self->next + self->to_read || !__is_digit(*p)) return -1;
+
+    self->to_read -= p - self->next;
+    self->next = (char *)p;
+    return 1;
+}
+
+/* Consumes the digits at the stream's position, across refills; returns their value, flagging `overflow` */
+static u64 __int_digits(bufread_t * self, i32 * overflow) {
+    u64 x = 0;
+
+    for(;;) {
+        const char * p = self->next;
+        const char * const end = p + self->to_read;
+
+        for(; end - p >= 8; p += 8) {
+            const u64 w = __load8(p);
+            if(!__all_digits8(w)) break;
+            *overflow |= __builtin_mul_overflow(x, 100000000, &x) | __builtin_add_overflow(x, __eight_digits(w), &x);
+        }
+        for(; p < end && __is_digit(*p); p++) {
+            *overflow |= __builtin_mul_overflow(x, 10, &x) | __builtin_add_overflow(x, (u64)(*p - '0'), &x);
+        }
+
+        self->to_read -= p - self->next;
+        self->next = (char *)p;
+        if(p < end || __fill(self) == 0) return x;
     }
 }
 
-i16 atlib_bufread_read_i16_be(bufread_t * self) {
+i32 atlib_bufread_parse_u64(bufread_t * restrict self, u64 * restrict out) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
-    atlib_compassert(self->next);
+    atlib_compassert(__is_open(self));
+    atlib_compassert(out);
 
-    if(self->to_read < 2 && __fill(self) < 2) {
-        return 0;
-    }
-    self->to_read -= 2;
-    i16 ret = *self->next++ & UBYTE_MASK;
-    return (ret << 8) | (*self->next++ & UBYTE_MASK);
+    i32 neg, overflow = 0;
+    const i32 r = __int_start(self, &neg, 0);
+    if(r <= 0) return r;
+
+    const u64 v = __int_digits(self, &overflow);
+    *out = overflow ? UINT64_MAX : v;
+    return overflow ? -1 : 1;
 }
 
-i16 atlib_bufread_read_i16_le(bufread_t * self) {
+i32 atlib_bufread_parse_i64(bufread_t * restrict self, i64 * restrict out) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
-    atlib_compassert(self->next);
+    atlib_compassert(__is_open(self));
+    atlib_compassert(out);
+
+    i32 neg, overflow = 0;
+    const i32 r = __int_start(self, &neg, 1);
+    if(r <= 0) return r;
+
+    /* The magnitude of the most negative value is one past the largest positive one */
+    const u64 v = __int_digits(self, &overflow);
+    if(overflow || v > (u64)INT64_MAX + neg) {
+        *out = neg ? INT64_MIN : INT64_MAX;
+        return -1;
+    }
+    *out = neg ? (i64)(0 - v) : (i64)v;
+    return 1;
+}
 
-    if(self->to_read < 2 && __fill(self) < 2) {
-        return 0;
+/* Powers of ten that are exact as doubles */
+static const f64 __pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/* Whether `c` can be part of a decimal number, "inf", "infinity", or "nan", in either case */
+static inline i32 __is_float_char(const char c) {
+    if(__is_digit(c) || c == '.' || c == '+' || c == '-') return 1;
+    switch(c | 0x20) {
+    case 'e': case 'i': case 'n': case 'f': case 'a': case 't': case 'y': return 1;
+    default: return 0;
     }
-    self->to_read -= 2;
-    i16 ret = *self->next++ & UBYTE_MASK;
-    return (ret) | ((*self->next++ & UBYTE_MASK) << 8);
 }
 
-i32 atlib_bufread_read_i32(bufread_t * self) {
-    atlib_compassert(self);
-    atlib_compassert(self->fh);
-    atlib_compassert(self->next);
-
-    if(self->to_read < 4 && __fill(self) < 4) return 0;
-    self->to_read -= 4;
-    i32 ret = *self->next++ & UBYTE_MASK;
-    
-    if(self->flags & BUFREAD_READ_BE) {
-        ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-        ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-        return (ret << 8) | (*self->next++ & UBYTE_MASK);
+/* The longest run of number characters atlib_bufread_parse_f64 reads as one number */
+#define __FLOAT_MAX 800
+
+/* Scans the unsigned decimal at `p` into `m * 10^e`; returns its end, or `p` if there is none */
+static const char * __scan_decimal(const char * p, const char * const end, u64 * m, i64 * e, i32 * truncated) {
+    const char * const start = p;
+    u64 w = 0;
+    i64 x = 0;
+    i32 nd = 0;
+
+    /* Up to 19 significant digits fit in a u64; leading zeros do not count */
+    for(; end - p >= 8 && nd <= 11; p += 8) {
+        const u64 v = __load8(p);
+        if(!__all_digits8(v)) break;
+        w = w * 100000000 + __eight_digits(v);
+        nd = w ? nd + 8 : 0;
     }
-    else {
-        ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-        ret = (ret) | ((*self->next++ & UBYTE_MASK) << 16);
-        return (ret) | ((*self->next++ & UBYTE_MASK) << 24);
+    for(; p < end && __is_digit(*p); p++) {
+        if(nd < 19) {
+            w = w * 10 + (*p - '0');
+            nd += w != 0;
+        }
+        else {
+            x++;
+            *truncated |= *p != '0';
+        }
+    }
+    i32 digits = p != start;
+
+    if(p < end && *p == '.') {
+        const char * const frac = ++p;
+        for(; p < end && __is_digit(*p); p++) {
+            if(nd < 19) {
+                w = w * 10 + (*p - '0');
+                nd += w != 0;
+                x--;
+            }
+            else *truncated |= *p != '0';
+        }
+        digits |= p != frac;
     }
+    if(!digits) return start;
+
+    /* An exponent without digits is not part of the number */
+    if(p < end && (*p | 0x20) == 'e') {
+        const char * q = p + 1;
+        const i32 neg = q < end && *q == '-';
+        if(q < end && (*q == '-' || *q == '+')) q++;
+        if(q < end && __is_digit(*q)) {
+            i64 y = 0;
+            for(; q < end && __is_digit(*q); q++) if(y < 100000) y = y * 10 + (*q - '0');
+            x += neg ? -y : y;
+            p = q;
+        }
+    }
+
+    *m = w;
+    *e = x;
+    return p;
 }
 
-i32 atlib_bufread_read_i32_be(bufread_t * self) {
-    atlib_compassert(self);
-    atlib_compassert(self->fh);
+/* Parses the first `n` bytes at `p`, at most __FLOAT_MAX, with strtod(3); returns the number of bytes it used */
+static usize __strtod(const char * p, usize n, f64 * v) {
+    char tmp[__FLOAT_MAX + 1];
+    atlib_compassert(n <= __FLOAT_MAX);
 
-    if(self->to_read < 4 && __fill(self) < 4) return 0;
-    self->to_read -= 4;
-    i32 ret = *self->next++ & UBYTE_MASK;
-    ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-    ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-    return (ret << 8) | (*self->next++ & UBYTE_MASK);
+    memcpy(tmp, p, n);
+    tmp[n] = 0;
+
+    char * end;
+    *v = strtod(tmp, &end);
+    return end - tmp;
 }
 
-i32 atlib_bufread_read_i32_le(bufread_t * self) {
-    atlib_compassert(self);
-    atlib_compassert(self->fh);
+/* Parses the number at the start of the `run` number characters at `tok`; returns the bytes it used, or 0 if there is none */
+static usize __parse_float(const char * tok, usize run, f64 * v) {
+    const char * const p = tok + (*tok == '-' || *tok == '+');
+    const char * end;
+    u64 m;
+    i64 e;
+    i32 truncated = 0;
+
+    /* Not a decimal; "inf", "nan", and the like are left to strtod */
+    if((end = __scan_decimal(p, tok + run, &m, &e, &truncated)) == p) return __strtod(tok, run, v);
+
+    if(!truncated && e >= -22 && e <= 22 && m <= (u64)1 << 53) {
+        /* Both operands are exact, so the one rounding of the division or product is correct */
+        *v = e < 0 ? (f64)m / __pow10[-e] : (f64)m * __pow10[e];
+        if(*tok == '-') *v = -*v;
+    }
+    else if(m == 0 && !truncated) *v = *tok == '-' ? -0.0 : 0.0;
+    else end = tok + __strtod(tok, end - tok, v);
 
-    if(self->to_read < 4 && __fill(self) < 4) return 0;
-    self->to_read -= 4;
-    i32 ret = *self->next++ & UBYTE_MASK;
-    ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-    ret = (ret) | ((*self->next++ & UBYTE_MASK) << 16);
-    return (ret) | ((*self->next++ & UBYTE_MASK) << 24);
+    return end - tok;
 }
 
-i64 atlib_bufread_read_i64(bufread_t * self) {
-    atlib_compassert(self);
-    atlib_compassert(self->fh);
-    atlib_compassert(self->next);
-
-    if(self->to_read < 8 && __fill(self) < 8) return 0;
-    self->to_read -= 8;
-    i64 ret = *self->next++ & UBYTE_MASK;
-    if(self->flags & BUFREAD_READ_BE) {
-        ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-        ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-        ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-        ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-        ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-        ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-        return (ret << 8) | (*self->next++ & UBYTE_MASK);
+/* Parses a number that does not fit in the buffer, gathering it across refills */
+static i32 __parse_float_long(bufread_t * self, f64 * out) {
+    char tmp[__FLOAT_MAX];
+    usize len = 0, last = 0;
+    i32 over = 0;
+
+    for(;;) {
+        const char * p = self->next;
+        const char * const end = p + self->to_read;
+        while(p < end && __is_float_char(*p)) p++;
+
+        /* Past the longest number, the rest of the run is only skipped */
+        last = p - self->next;
+        if(len + last > __FLOAT_MAX) over = 1;
+        else memcpy(tmp + len, self->next, last);
+        len += last;
+        self->next += last;
+        self->to_read -= last;
+
+        if(p < end) break;
+        last = 0;
+        if(__fill(self) == 0) break;
     }
-    else {
-        ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-        ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-        ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-        ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-        ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-        ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-        return (ret) | ((*self->next++ & UBYTE_MASK) << 8);
+    if(over) return -1;
+
+    const usize used = __parse_float(tmp, len, out);
+
+    /* Give back what follows the number, when it still lies in the buffer */
+    const usize back = len - used;
+    if(back <= last) {
+        self->next -= back;
+        self->to_read += back;
     }
+    return used ? 1 : -1;
 }
 
-i64 atlib_bufread_read_i64_be(bufread_t * self) {
+i32 atlib_bufread_parse_f64(bufread_t * restrict self, f64 * restrict out) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
+    atlib_compassert(__is_open(self));
+    atlib_compassert(out);
 
-    if(self->to_read < 8 && __fill(self) < 8) return 0;
+    if(!__skip_space(self)) return 0;
 
-    self->to_read -= 8;
-    i64 ret = *self->next++ & UBYTE_MASK;
-    ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-    ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-    ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-    ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-    ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-    ret = (ret << 8) | (*self->next++ & UBYTE_MASK);
-    return (ret << 8) | (*self->next++ & UBYTE_MASK);
-}
+    /* The whole number must be in view; refill until it ends inside the buffer, which never grows for it */
+    usize run;
+    for(;;) {
+        const char * p = self->next;
+        const char * const end = p + self->to_read;
+        while(p < end && __is_float_char(*p)) p++;
 
-i64 atlib_bufread_read_i64_le(bufread_t * self) {
-    atlib_compassert(self);
-    atlib_compassert(self->fh);
+        run = p - self->next;
+        if(p < end || self->flags & __IN_VIEW) break;
+        if((usize)self->to_read == self->cap) return __parse_float_long(self, out);
 
-    if(self->to_read < 8 && __fill(self) < 8) return 0;
+        const isize had = self->to_read;
+        if(__fill(self) == had) break;
+    }
 
-    self->to_read -= 8;
-    i64 ret = *self->next++ & UBYTE_MASK;
-    ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-    ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-    ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-    ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-    ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-    ret = (ret) | ((*self->next++ & UBYTE_MASK) << 8);
-    return (ret) | ((*self->next++ & UBYTE_MASK) << 8);
+    if(run > __FLOAT_MAX) {
+        self->next += run;
+        self->to_read -= run;
+        return -1;
+    }
+
+    f64 v;
+    const usize used = __parse_float(self->next, run, &v);
+    if(used == 0) return -1;
+
+    self->to_read -= used;
+    self->next += used;
+    *out = v;
+    return 1;
 }
 
 void atlib_bufread_skip(bufread_t * self, isize n) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
-
-    if(ferror(self->fh)) return;
+    atlib_compassert(__is_open(self));
 
-    if(self->to_read >= n) {
+    /* Only a forward skip is sure to stay in the buffer; anything else may leave the window */
+    if(0 <= n && n <= self->to_read) {
         self->to_read -= n;
         self->next += n;
         return;
     }
 
-    if(!fseek(self->fh, n, SEEK_CUR)) return;
-
-    self->to_read = 0;
-    self->next = self->buf;
+    /* Like a rewind, a skip back past the start of the stream stops at the start */
+    const usize pos = atlib_bufread_pos(self);
+    atlib_bufread_seek(self, n < 0 && (usize)-n > pos ? 0 : pos + n);
 }
 
 void atlib_bufread_rewind(bufread_t * self, usize n) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
+    atlib_compassert(__is_open(self));
+
+    const usize pos = atlib_bufread_pos(self);
+    atlib_bufread_seek(self, n > pos ? 0 : pos - n);
+}
+
+void atlib_bufread_seek(bufread_t * self, usize n) {
+    atlib_compassert(self);
+    atlib_compassert(__is_open(self));
 
-    if(ferror(self->fh)) return;
+    if(n > self->lim) n = self->lim;
 
-    if((usize)self->next - (usize)self->buf >= n) {
-        self->to_read += n;
-        self->next -= n;
+    /* The mapping, or memory, covers the whole source, so every target is inside the window */
+    if(self->flags & __IN_VIEW) {
+        if(n > self->off) n = self->off;
+        self->flags &= ~BUFREAD_EOF;
+    }
+    else if(self->flags & BUFREAD_ERR) return;
+
+    /* Land inside the current window without touching the file */
+    char * const lo = self->ahead ? self->ahead->lo : self->base;
+    const usize start = self->off - (self->next - lo) - self->to_read;
+    if(n >= start && n <= self->off) {
+        self->next = lo + (n - start);
+        self->to_read = self->off - n;
         return;
     }
 
-    if(fseek(self->fh, -1 * n, SEEK_CUR)) return;
-
-    self->to_read = 0;
-    self->next = self->buf;
-}
+    /* The helper must not be reading while the file moves under it */
+    struct __bufread_ahead * const a = self->ahead;
+    if(a) {
+        pthread_mutex_lock(&a->lock);
+        __ahead_wait(a);
+    }
 
-void atlib_bufread_seek(bufread_t * self, usize n) {
-    atlib_compassert(self);
-    atlib_compassert(self->fh);
+    /* Cached blocks are read at their own offset, so the file never has to move */
+    i32 moved;
+    if(self->cache) moved = 1;
+    else if(self->flags & BUFREAD_FD) moved = lseek(self->fd, n, SEEK_SET) >= 0;
+    else moved = fseek(self->fh, n, SEEK_SET) == 0;
+
+    /* Whatever was read ahead belongs to the old position */
+    if(a) {
+        if(moved) {
+            __ahead_kick(a);
+            a->lo = self->base;
+        }
+        pthread_mutex_unlock(&a->lock);
+    }
+    if(!moved) return;
 
-    if(ferror(self->fh) || fseek(self->fh, n, SEEK_SET)) return;
+    self->off = n;
     self->to_read = 0;
-    self->next = self->buf;
+    self->next = self->base;
+    self->flags &= ~BUFREAD_EOF;
 }
@@ -0,0 +1,359 @@
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+#include "Atlib/io/bufrecord.h"
+#include "Atlib/io/endian.h"
+#include "Atlib/error.h"
+
+/* What a step does; the fixed-size copies and swaps compile down to a single load and store */
+#define __COPY  0   /* Copies `len` bytes */
+#define __C1    1
+#define __C2    2
+#define __C4    3
+#define __C8    4
+#define __S2    5   /* Copies and swaps a 16-bit value */
+#define __S4    6
+#define __S8    7
+
+/* The fields of a record that the step covers, merged whenever they are laid out the same way */
+struct __bufrecord_op {
+    u32 kind;
+    usize src;                      /* The offset within the record */
+    usize dst;                      /* The offset within the struct */
+    usize len;
+};
+
+/* The largest record encoded on the stack when it does not fit in the writer's buffer */
+#define __TMP 256
+
+static inline usize __width(const bufrecord_field_t * f) {
+    return f->type == BUFRECORD_BYTES ? f->len : (f->type & 0x0f);
+}
+
+/* Whether the field has to be byte swapped on this host */
+static inline i32 __swapped(const bufrecord_field_t * f) {
+    if(f->type == BUFRECORD_BYTES || __width(f) == 1) return 0;
+#if ATLIB_ENDIAN == ATLIB_LITTLE_ENDIAN
+    return f->order == BUFRECORD_BE;
+#else
+    return f->order == BUFRECORD_LE;
+#endif
+}
+
+static int __by_off(const void * a, const void * b) {
+    const usize x = ((const bufrecord_field_t *)a)->off, y = ((const bufrecord_field_t *)b)->off;
+    return (x > y) - (x < y);
+}
+
+/* Whether the field describes a type, order, and member that can be decoded */
+static i32 __valid(const bufrecord_field_t * f, usize size, usize stride) {
+    switch(f->type) {
+    case BUFRECORD_U8: case BUFRECORD_U16: case BUFRECORD_U32: case BUFRECORD_U64:
+    case BUFRECORD_I8: case BUFRECORD_I16: case BUFRECORD_I32: case BUFRECORD_I64:
+    case BUFRECORD_F32: case BUFRECORD_F64: case BUFRECORD_BYTES:
+        break;
+    default:
+        return 0;
+    }
+
+    const usize w = __width(f);
+    return w > 0 && w == f->len && f->order <= BUFRECORD_LE && f->off + w <= size && f->dst + w <= stride;
+}
+
+/* Builds the shuffles moving a record into a struct and back, if both fit in one vector */
+static void __compile_shuffle(bufrecord_t * self, const bufrecord_field_t * f, usize n) {
+    memset(self->dec, 0x80, 16);
+    memset(self->enc, 0x80, 16);
+    memset(self->keep, 0xff, 16);
+    self->shuffle = 0;
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+    if(self->size > 16 || self->stride > 16) return;
+
+    for(usize i = 0; i < n; i++) {
+        const usize w = __width(&f[i]);
+        const i32 swap = __swapped(&f[i]);
+
+        for(usize k = 0; k < w; k++) {
+            const usize s = f[i].off + (swap ? w - 1 - k : k);
+            self->dec[f[i].dst + k] = s;
+            self->enc[s] = f[i].dst + k;
+            self->keep[f[i].dst + k] = 0;
+        }
+    }
+
+    /* A struct wholly covered by its fields can be stored straight from the shuffle */
+    self->shuffle = 1;
+    if(self->stride == 16) {
+        u8 any = 0;
+        for(usize i = 0; i < 16; i++) any |= self->keep[i];
+        if(any == 0) self->shuffle = 2;
+    }
+#else
+    (void)f;
+    (void)n;
+#endif
+}
+
+bufrecord_t * atlib_bufrecord_compile(bufrecord_t * restrict self, const bufrecord_field_t * restrict fields, usize n, usize size, usize stride) {
+    atlib_compassert(self);
+    atlib_compassert(fields);
+    atlib_compassert(size > 0);
+
+    bufrecord_field_t * f = malloc((n ? n : 1) * sizeof(*f));
+    struct __bufrecord_op * ops = malloc((n ? n : 1) * sizeof(*ops));
+    if(f == NULL || ops == NULL) goto err;
+
+    memcpy(f, fields, n * sizeof(*f));
+    qsort(f, n, sizeof(*f), __by_off);
+
+    usize covered = 0;
+    for(usize i = 0; i < n; i++) {
+        if(!__valid(&f[i], size, stride)) goto err;
+        if(i > 0 && f[i - 1].off + __width(&f[i - 1]) > f[i].off) goto err;
+
+        /* Members may be listed in any order, so their overlaps are checked pairwise */
+        for(usize j = 0; j < i; j++) {
+            if(f[j].dst < f[i].dst + __width(&f[i]) && f[i].dst < f[j].dst + __width(&f[j])) goto err;
+        }
+        covered += __width(&f[i]);
+    }
+
+    usize k = 0;
+    for(usize i = 0; i < n; i++) {
+        const usize w = __width(&f[i]);
+
+        if(__swapped(&f[i])) {
+            ops[k++] = (struct __bufrecord_op){ .kind = w == 2 ? __S2 : w == 4 ? __S4 : __S8, .src = f[i].off, .dst = f[i].dst, .len = w };
+            continue;
+        }
+
+        /* A field following on from the last copy, in both the record and the struct, extends it */
+        struct __bufrecord_op * const last = k > 0 ? &ops[k - 1] : nullptr;
+        if(last && last->kind < __S2 && last->src + last->len == f[i].off && last->dst + last->len == f[i].dst) {
+            last->len += w;
+            last->kind = __COPY;
+        }
+        else ops[k++] = (struct __bufrecord_op){ .kind = __COPY, .src = f[i].off, .dst = f[i].dst, .len = w };
+    }
+
+    for(usize i = 0; i < k; i++) {
+        if(ops[i].kind != __COPY) continue;
+        switch(ops[i].len) {
+        case 1: ops[i].kind = __C1; break;
+        case 2: ops[i].kind = __C2; break;
+        case 4: ops[i].kind = __C4; break;
+        case 8: ops[i].kind = __C8; break;
+        }
+    }
+
+    self->size = size;
+    self->stride = stride;
+    self->nops = k;
+    self->ops = ops;
+    self->covered = covered == size;
+    __compile_shuffle(self, f, n);
+
+    free(f);
+    return self;
+
+err:
+    free(ops);
+    free(f);
+    return NULL;
+}
+
+void atlib_bufrecord_free(bufrecord_t * self) {
+    atlib_compassert(self);
+
+    free(self->ops);
+    self->ops = nullptr;
+    self->nops = 0;
+}
+
+/* Records are run through the plan in chunks, so a chunk is still cached when its next step runs */
+#define __CHUNK 128
+
+/* Runs a step over `k` records, one value at a time, swapped by `swap` */
+#define __STEP(type, swap) \
+    for(usize j = 0; j < k; j++, to += ts, from += fs) { \
+        type v; \
+        memcpy(&v, from, sizeof(v)); \
+        v = swap(v); \
+        memcpy(to, &v, sizeof(v)); \
+    }
+
+#define __AS_IS(v) (v)
+
+/* Runs the plan over `k` records one step at a time, so each step is a tight loop; `dec` moves the records `r` into the structs `s`, otherwise the other way */
+static void __run(const bufrecord_t * self, char * restrict r, char * restrict s, usize k, const i32 dec) {
+    const usize ts = dec ? self->stride : self->size;
+    const usize fs = dec ? self->size : self->stride;
+
+    for(usize i = 0; i < self->nops; i++) {
+        const struct __bufrecord_op * const op = &self->ops[i];
+        char * to = dec ? s + op->dst : r + op->src;
+        const char * from = dec ? r + op->src : s + op->dst;
+
+        switch(op->kind) {
+        case __COPY:
+            for(usize j = 0; j < k; j++, to += ts, from += fs) memcpy(to, from, op->len);
+            break;
+        case __C1: __STEP(u8, __AS_IS) break;
+        case __C2: __STEP(u16, __AS_IS) break;
+        case __C4: __STEP(u32, __AS_IS) break;
+        case __C8: __STEP(u64, __AS_IS) break;
+        case __S2: __STEP(u16, __builtin_bswap16) break;
+        case __S4: __STEP(u32, __builtin_bswap32) break;
+        case __S8: __STEP(u64, __builtin_bswap64) break;
+        }
+    }
+}
+
+/* How many of `k` items, `step` bytes apart and followed by `avail` bytes in all, have 16 bytes to load or store as one vector */
+static inline usize __vectors(const bufrecord_t * self, usize k, usize avail, usize step) {
+    if(!self->shuffle || avail < 16) return 0;
+
+    const usize m = (avail - 16) / step + 1;
+    return m < k ? m : k;
+}
+
+/* Decodes `k` records at `src`, followed by at least `avail` readable bytes in all, into `dst` */
+static void __decode(const bufrecord_t * self, char * restrict dst, const char * restrict src, usize k, usize avail) {
+    usize i = 0;
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+    const usize m = __vectors(self, k, avail, self->size);
+    const __m128i shuf = _mm_loadu_si128((const __m128i *)self->dec);
+    const __m128i keep = _mm_loadu_si128((const __m128i *)self->keep);
+
+    for(; i < m; i++, dst += self->stride, src += self->size) {
+        const __m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)src), shuf);
+        if(self->shuffle == 2) {
+            _mm_storeu_si128((__m128i *)dst, x);
+            continue;
+        }
+
+        /* Members no field covers keep their value; a smaller struct is merged aside, so nothing past it is written */
+        if(self->stride == 16) {
+            _mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_and_si128(_mm_loadu_si128((const __m128i *)dst), keep), x));
+            continue;
+        }
+
+        char t[16];
+        memcpy(t, dst, self->stride);
+        _mm_storeu_si128((__m128i *)t, _mm_or_si128(_mm_and_si128(_mm_loadu_si128((const __m128i *)t), keep), x));
+        memcpy(dst, t, self->stride);
+    }
+#else
+    (void)avail;
+#endif
+
+    for(; i < k; i += __CHUNK) {
+        const usize c = k - i < __CHUNK ? k - i : __CHUNK;
+        __run(self, (char *)src, dst, c, 1);
+        dst += c * self->stride;
+        src += c * self->size;
+    }
+}
+
+/* Encodes the `k` structs at `src`, followed by `avail` readable bytes in all, into `dst`, followed by `room` writable bytes */
+static void __encode(const bufrecord_t * self, char * restrict dst, const char * restrict src, usize k, usize avail, usize room) {
+    usize i = 0;
+
+    if(!self->covered) memset(dst, 0, k * self->size);
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+    /* Each vector store spills past its record, which is fine as long as the buffer has room for it */
+    usize m = __vectors(self, k, avail, self->stride);
+    const usize w = __vectors(self, k, room, self->size);
+    if(m > w) m = w;
+    const __m128i shuf = _mm_loadu_si128((const __m128i *)self->enc);
+
+    /* Bytes of the record no field covers come out of the shuffle as zeros */
+    for(; i < m; i++, dst += self->size, src += self->stride) {
+        _mm_storeu_si128((__m128i *)dst, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)src), shuf));
+    }
+#else
+    (void)avail;
+    (void)room;
+#endif
+
+    for(; i < k; i += __CHUNK) {
+        const usize c = k - i < __CHUNK ? k - i : __CHUNK;
+        __run(self, dst, (char *)src, c, 0);
+        dst += c * self->size;
+        src += c * self->stride;
+    }
+}
+
+usize atlib_bufrecord_decode(const bufrecord_t * restrict self, bufread_t * restrict br, void * restrict dst, usize n) {
+    atlib_compassert(self);
+    atlib_compassert(br);
+    atlib_compassert(dst);
+
+    char * d = dst;
+    usize done = 0;
+
+    while(done < n) {
+        /* A record larger than the buffer grows it */
+        while((usize)br->to_read < self->size) {
+            if(__atlib_bufread_more(br) == 0) return done;
+        }
+
+        usize k = br->to_read / self->size;
+        if(k > n - done) k = n - done;
+
+        __decode(self, d, br->next, k, br->to_read);
+        br->next += k * self->size;
+        br->to_read -= k * self->size;
+        d += k * self->stride;
+        done += k;
+    }
+
+    return done;
+}
+
+usize atlib_bufrecord_encode(const bufrecord_t * restrict self, bufwrite_t * restrict bw, const void * restrict src, usize n) {
+    atlib_compassert(self);
+    atlib_compassert(bw);
+    atlib_compassert(src);
+
+    const char * s = src;
+    usize done = 0;
+
+    while(done < n) {
+        /* A record that does not fit is encoded aside, and handed over as a whole */
+        if((usize)bw->to_write < self->size) {
+            char tmp[__TMP + 16];
+            char * rec = self->size <= __TMP ? tmp : malloc(self->size + 16);
+            if(rec == NULL) break;
+
+            __encode(self, rec, s, 1, (n - done) * self->stride, self->size + 16);
+            const i32 ok = __atlib_bufwrite_spill(bw, rec, self->size);
+            if(rec != tmp) free(rec);
+            if(!ok) break;
+
+            s += self->stride;
+            done++;
+            continue;
+        }
+
+        usize k = bw->to_write / self->size;
+        if(k > n - done) k = n - done;
+
+        __encode(self, bw->next, s, k, (n - done) * self->stride, bw->to_write);
+        bw->next += k * self->size;
+        bw->to_write -= k * self->size;
+        s += k * self->stride;
+        done += k;
+    }
+
+    return done;
+}
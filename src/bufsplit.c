@@ -0,0 +1,118 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "Atlib/io/bufsplit.h"
+#include "Atlib/error.h"
+
+/* One range of the file, and the thread working through it */
+struct __worker {
+    pthread_t thread;
+    i32 joined;
+    i32 res;
+    usize idx;
+    bufrange_t range;
+    const char * path;
+    u32 flags;
+    bufread_worker_t fn;
+    void * arg;
+    bufread_t br;
+};
+
+static void * __run(void * p) {
+    struct __worker * w = p;
+
+    if(atlib_bufread_open_range(&w->br, w->path, w->range, w->flags) == NULL) {
+        w->res = -1;
+        return nullptr;
+    }
+    w->res = w->fn(&w->br, w->idx, w->arg);
+    atlib_bufread_close(&w->br);
+
+    return nullptr;
+}
+
+isize atlib_bufread_split(const char * restrict file_path, const char * restrict delim, usize dlen, bufrange_t * restrict ranges, usize n) {
+    atlib_compassert(file_path);
+    atlib_compassert(delim);
+    atlib_compassert(dlen > 0);
+    atlib_compassert(ranges);
+
+    bufread_t br;
+    struct stat st;
+    if(atlib_bufread_open(&br, file_path, BUFREAD_FD) == NULL) return -1;
+    if(fstat(br.fd, &st)) {
+        atlib_bufread_close(&br);
+        return -1;
+    }
+
+    const usize size = st.st_size;
+    usize k = 0;
+    usize start = 0;
+
+    for(usize i = 1; i <= n && start < size; i++) {
+        usize end = size;
+
+        /* Move each cut forward to just past the end of the record it lands in */
+        if(i < n) {
+            const usize cut = size / n * i + size % n * i / n;
+            bufview_t rec;
+
+            atlib_bufread_seek(&br, cut > start ? cut : start);
+            if(atlib_bufread_next_delim(&br, delim, dlen, &rec)) end = atlib_bufread_pos(&br);
+        }
+
+        ranges[k++] = (bufrange_t){ .start = start, .end = end };
+        start = end;
+    }
+
+    atlib_bufread_close(&br);
+    return k;
+}
+
+i32 atlib_bufread_parallel(const char * restrict file_path, const char * restrict delim, usize dlen, usize n, u32 br_flags, bufread_worker_t fn, void * arg) {
+    atlib_compassert(file_path);
+    atlib_compassert(delim);
+    atlib_compassert(fn);
+
+    if(n == 0) {
+        const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        n = cpus > 0 ? cpus : 1;
+    }
+
+    bufrange_t * ranges = malloc(n * sizeof(*ranges));
+    struct __worker * w = malloc(n * sizeof(*w));
+    i32 res = -1;
+    if(ranges == NULL || w == NULL) goto alloc_err;
+
+    const isize k = atlib_bufread_split(file_path, delim, dlen, ranges, n);
+    if(k < 0) goto alloc_err;
+
+    for(isize i = 0; i < k; i++) {
+        w[i] = (struct __worker){
+            .idx = i, .range = ranges[i], .path = file_path, .flags = br_flags, .fn = fn, .arg = arg,
+        };
+    }
+
+    /* Ranges whose thread cannot be started are processed here instead */
+    for(isize i = 1; i < k; i++) {
+        if(pthread_create(&w[i].thread, NULL, __run, &w[i])) {
+            w[i].joined = 1;
+            __run(&w[i]);
+        }
+    }
+    if(k > 0) __run(&w[0]);
+
+    res = 0;
+    for(isize i = 0; i < k; i++) {
+        if(i > 0 && !w[i].joined) pthread_join(w[i].thread, NULL);
+        if(res == 0) res = w[i].res;
+    }
+
+alloc_err:
+    free(w);
+    free(ranges);
+    return res;
+}
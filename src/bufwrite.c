@@ -1,38 +1,242 @@
+#define _GNU_SOURCE
+/* Emits the exported definitions of the inline writers declared in bufwrite.h */
+#define __ATLIB_BUFWRITE_INLINE_EXPORT
 #include <stdio.h>
 #include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <wchar.h>
 
 #include "Atlib/error.h"
 #include "Atlib/io/bufwrite.h"
 
-#define UBYTE_MASK 0x00ff
-#define BYTE_MASK 0xff
+static inline i32 __is_open(const bufwrite_t * self) {
+    return self->fh != nullptr || self->fd >= 0 || self->flags & BUFWRITE_MEM;
+}
+
+/* Writes all `n` bytes of `src` to the underlying file, retrying short writes; returns bytes written */
+static usize __sink(bufwrite_t * self, const char * src, usize n) {
+    usize i = 0;
+
+    if(self->flags & BUFWRITE_FD) {
+        while(i < n) {
+            const isize r = write(self->fd, src + i, n - i);
+            if(r < 0) {
+                if(errno == EINTR) continue;
+                self->flags |= BUFWRITE_ERR;
+                break;
+            }
+            i += r;
+        }
+    }
+    else if((i = fwrite(src, 1, n, self->fh)) < n || fflush(self->fh)) {
+        self->flags |= BUFWRITE_ERR;
+    }
+
+    self->off += i;
+    return i;
+}
+
+/* The most iovecs passed to a single `writev(2)` */
+#define __IOV_BATCH 64
+
+/* Writes the `plen` bytes of `pend`, then every byte of `iov`, to the underlying file; returns bytes written */
+static usize __sinkv(bufwrite_t * self, const char * pend, usize plen, const struct iovec * iov, i32 cnt) {
+    usize i = 0;
+
+    if(~self->flags & BUFWRITE_FD) {
+        if(plen) i = __sink(self, pend, plen);
+        for(i32 j = 0; j < cnt && !(self->flags & BUFWRITE_ERR); j++) {
+            if(iov[j].iov_len) i += __sink(self, iov[j].iov_base, iov[j].iov_len);
+        }
+        return i;
+    }
+
+    struct iovec v[__IOV_BATCH];
+    i32 m = 0, at = 0;
+    if(plen) v[m++] = (struct iovec){ .iov_base = (void *)pend, .iov_len = plen };
+
+    for(;;) {
+        while(m < __IOV_BATCH && at < cnt) v[m++] = iov[at++];
+        if(m == 0) break;
+
+        const isize r = writev(self->fd, v, m);
+        if(r < 0) {
+            if(errno == EINTR) continue;
+            self->flags |= BUFWRITE_ERR;
+            break;
+        }
+        i += r;
+
+        /* Drop what was written, resuming partway into an iovec after a short write */
+        usize k = r;
+        i32 s = 0;
+        while(s < m && k >= v[s].iov_len) k -= v[s++].iov_len;
+        if(s == 0 && r == 0) {
+            self->flags |= BUFWRITE_ERR;
+            break;
+        }
+        if(s < m) {
+            v[s].iov_base = (char *)v[s].iov_base + k;
+            v[s].iov_len -= k;
+        }
+        memmove(v, v + s, (m - s) * sizeof(*v));
+        m -= s;
+    }
+
+    self->off += i;
+    return i;
+}
+
+/* A full buffer handed to a ring, written while the stream fills its other buffer */
+struct __bufwrite_queue {
+    uring_t * ring;
+    struct __atlib_uring_op op;
+    char * back;
+    usize len;
+    usize done;
+    i32 busy;
+};
+
+/* Blocks until the queued buffer has been written in full, requeueing what a short write left over */
+static void __queue_wait(bufwrite_t * self) {
+    struct __bufwrite_queue * q = self->queue;
+
+    while(q->busy) {
+        __atlib_uring_wait(q->ring, &q->op);
+        if(q->op.res <= 0) {
+            self->flags |= BUFWRITE_ERR;
+            q->busy = 0;
+        }
+        else if((q->done += q->op.res) == q->len) q->busy = 0;
+        else if(!__atlib_uring_queue(q->ring, &q->op, 1, self->fd, q->back + q->done, q->len - q->done)) {
+            self->flags |= BUFWRITE_ERR;
+            q->busy = 0;
+        }
+    }
+}
+
+/* Queues the buffer on the ring and carries on in the other one; returns bytes queued */
+static usize __flush_queue(bufwrite_t * self) {
+    struct __bufwrite_queue * q = self->queue;
+    const usize n = self->cap - self->to_write;
+
+    __queue_wait(self);
+    if(self->flags & BUFWRITE_ERR || n == 0) return 0;
+    if(!__atlib_uring_queue(q->ring, &q->op, 1, self->fd, self->base, n)) {
+        self->flags |= BUFWRITE_ERR;
+        return 0;
+    }
+
+    char * const t = q->back;
+    q->back = self->base;
+    q->len = n;
+    q->done = 0;
+    q->busy = 1;
+
+    self->base = t;
+    self->next = self->base;
+    self->to_write = self->cap;
+    self->off += n;
+    return n;
+}
+
+/* Grows a memory stream's buffer to at least double, and to fit `n` more bytes; returns bytes of room added */
+static usize __grow(bufwrite_t * self, usize n) {
+    const usize used = self->cap - self->to_write;
+    usize cap = self->cap * 2;
+    if(cap < used + n) cap = used + n;
+
+    /* The internal buffer, or one supplied by the caller, is left in place */
+    char * mem;
+    if(self->flags & BUFWRITE_BUF_ALLOC) mem = realloc(self->base, cap);
+    else if((mem = malloc(cap))) memcpy(mem, self->base, used);
+    if(mem == NULL) {
+        self->flags |= BUFWRITE_ERR;
+        return 0;
+    }
+
+    const usize added = cap - self->cap;
+    self->flags |= BUFWRITE_BUF_ALLOC;
+    self->base = mem;
+    self->cap = cap;
+    self->next = mem + used;
+    self->to_write = cap - used;
+    return added;
+}
 
 static usize __flush(bufwrite_t * self) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
+    atlib_compassert(__is_open(self));
 
+    /* A memory stream keeps everything, so making room means growing */
+    if(self->flags & BUFWRITE_MEM) return self->flags & BUFWRITE_ERR ? 0 : __grow(self, 0);
+    if(self->queue) return __flush_queue(self);
+
+    const usize n = self->cap - self->to_write;
     usize i;
-    if(ferror(self->fh) || 
-            (i = fwrite(self->buf, 1, __ATLIB_BUFWRITE_SIZE - self->to_write, self->fh)) == 0) return 0;
+    if(self->flags & BUFWRITE_ERR || (i = __sink(self, self->base, n)) == 0) return 0;
 
-    self->next = self->buf;
-    self->to_write = __ATLIB_BUFWRITE_SIZE;
-    fflush(self->fh);
+    /* Keep whatever could not be written at the front of the buffer */
+    if(i < n) memmove(self->base, self->base + i, n - i);
+    self->next = self->base + (n - i);
+    self->to_write = self->cap - (n - i);
 
     return i;
 }
 
+/* Makes room for `n` more bytes, flushing or growing the buffer if need be; returns whether they now fit */
+static inline i32 __room(bufwrite_t * self, usize n) {
+    if((usize)self->to_write >= n) return 1;
+    if(self->flags & BUFWRITE_MEM) return self->flags & BUFWRITE_ERR ? 0 : __grow(self, n) > 0;
+
+    (void)__flush(self);
+    return (usize)self->to_write >= n;
+}
+
+static bufwrite_t * __init(bufwrite_t * self, u32 bw_flags) {
+    self->flags = bw_flags & ~(BUFWRITE_ERR | BUFWRITE_BUF_ALLOC);
+    self->base = self->buf;
+    self->cap = __ATLIB_BUFWRITE_SIZE;
+    self->next = self->base;
+    self->to_write = self->cap;
+    self->queue = nullptr;
+
+    long pos = 0;
+    if(self->flags & BUFWRITE_FD) pos = lseek(self->fd, 0, SEEK_CUR);
+    else if(~self->flags & BUFWRITE_MEM) pos = ftell(self->fh);
+    self->off = pos < 0 ? 0 : pos;
+
+    return self;
+}
+
 bufwrite_t * atlib_bufwrite_open(bufwrite_t * restrict self, const char * restrict file_path) {
+    return atlib_bufwrite_open_ex(self, file_path, BUFWRITE_FLAG_DEFAULT);
+}
+
+bufwrite_t * atlib_bufwrite_open_ex(bufwrite_t * restrict self, const char * restrict file_path, u32 bw_flags) {
     atlib_compassert(self);
+    atlib_compassert(file_path);
 
-    if((self->fh = fopen(file_path, "a")) == NULL) return NULL;
+    bw_flags &= ~BUFWRITE_FH_ATTACH;
 
-    self->next = self->buf;
-    self->to_write = __ATLIB_BUFWRITE_SIZE;
+    if(bw_flags & BUFWRITE_FD) {
+        if((self->fd = open(file_path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0666)) < 0) return NULL;
+        self->fh = nullptr;
+        (void)lseek(self->fd, 0, SEEK_END);
+        return __init(self, bw_flags);
+    }
 
-    return self;
+    if((self->fh = fopen(file_path, "a")) == NULL) return NULL;
+    self->fd = fileno(self->fh);
+
+    return __init(self, bw_flags);
 }
 
 bufwrite_t * atlib_bufwrite_fopen(bufwrite_t * restrict self, FILE * restrict file) {
@@ -40,242 +244,1071 @@ bufwrite_t * atlib_bufwrite_fopen(bufwrite_t * restrict self, FILE * restrict fi
     atlib_compassert(file);
 
     self->fh = file;
+    self->fd = fileno(file);
+
+    return __init(self, BUFWRITE_FLAG_DEFAULT);
+}
+
+bufwrite_t * atlib_bufwrite_fdopen(bufwrite_t * self, i32 fd) {
+    atlib_compassert(self);
+    atlib_compassert(fd >= 0);
+
+    self->fh = nullptr;
+    self->fd = fd;
+
+    return __init(self, BUFWRITE_FD | BUFWRITE_FH_ATTACH);
+}
+
+bufwrite_t * atlib_bufwrite_memopen(bufwrite_t * self) {
+    atlib_compassert(self);
+
+    self->fh = nullptr;
+    self->fd = -1;
+
+    return __init(self, BUFWRITE_MEM);
+}
+
+const char * atlib_bufwrite_membuf(const bufwrite_t * restrict self, usize * restrict len) {
+    atlib_compassert(self);
+    atlib_compassert(self->flags & BUFWRITE_MEM);
+    atlib_compassert(len);
+
+    *len = self->cap - self->to_write;
+    return self->base;
+}
+
+void * atlib_bufwrite_memtake(bufwrite_t * restrict self, usize * restrict len) {
+    atlib_compassert(self);
+    atlib_compassert(self->flags & BUFWRITE_MEM);
+    atlib_compassert(len);
 
-    self->next = self->buf;
-    self->to_write = __ATLIB_BUFWRITE_SIZE;
+    const usize n = self->cap - self->to_write;
+    char * mem = self->base;
 
+    /* Only a buffer allocated by AtLib can be handed over as it is */
+    if(~self->flags & BUFWRITE_BUF_ALLOC) {
+        if((mem = malloc(n ? n : 1)) == NULL) return NULL;
+        memcpy(mem, self->base, n);
+    }
+
+    self->flags &= ~BUFWRITE_BUF_ALLOC;
+    self->base = self->buf;
+    self->cap = __ATLIB_BUFWRITE_SIZE;
+    self->next = self->base;
+    self->to_write = self->cap;
+
+    *len = n;
+    return mem;
+}
+
+void atlib_bufwrite_memreset(bufwrite_t * self) {
+    atlib_compassert(self);
+    atlib_compassert(self->flags & BUFWRITE_MEM);
+
+    self->flags &= ~BUFWRITE_ERR;
+    self->next = self->base;
+    self->to_write = self->cap;
+}
+
+bufwrite_t * atlib_bufwrite_setbuf(bufwrite_t * self, void * buf, usize cap) {
+    atlib_compassert(self);
+    atlib_compassert(cap > 0);
+
+    const usize n = self->cap - self->to_write;
+    if(self->queue || n > cap) return NULL;
+
+    char * mem = buf;
+    if(mem == NULL && (mem = malloc(cap)) == NULL) return NULL;
+
+    memmove(mem, self->base, n);
+    if(self->flags & BUFWRITE_BUF_ALLOC) free(self->base);
+
+    if(buf == NULL) self->flags |= BUFWRITE_BUF_ALLOC;
+    else self->flags &= ~BUFWRITE_BUF_ALLOC;
+
+    self->base = mem;
+    self->cap = cap;
+    self->next = self->base + n;
+    self->to_write = cap - n;
     return self;
 }
 
+bufwrite_t * atlib_bufwrite_uring(bufwrite_t * self, uring_t * ring) {
+    atlib_compassert(self);
+    atlib_compassert(__is_open(self));
+    atlib_compassert(ring);
+
+    /* Writes are queued against the descriptor, so a FILE's own buffer would be skipped */
+    if(~self->flags & BUFWRITE_FD || self->queue) return NULL;
+
+    struct __bufwrite_queue * q = malloc(sizeof(*q));
+    if(q == NULL) return NULL;
+
+    /* Both buffers must belong to AtLib, as they trade places on every flush */
+    char * front = self->base;
+    if(~self->flags & BUFWRITE_BUF_ALLOC && (front = malloc(self->cap)) == NULL) goto front_err;
+    if((q->back = malloc(self->cap)) == NULL) goto back_err;
+
+    q->ring = ring;
+    q->len = 0;
+    q->done = 0;
+    q->busy = 0;
+
+    if(front != self->base) {
+        const usize n = self->cap - self->to_write;
+        memcpy(front, self->base, n);
+        self->base = front;
+        self->next = front + n;
+        self->flags |= BUFWRITE_BUF_ALLOC;
+    }
+    self->queue = q;
+    return self;
+
+back_err:
+    if(front != self->base) free(front);
+front_err:
+    free(q);
+    return NULL;
+}
+
 void atlib_bufwrite_close(bufwrite_t * self) {
     atlib_compassert(self);
 
-    (void)__flush(self);
-    fclose(self->fh);
+    if(~self->flags & BUFWRITE_MEM) (void)__flush(self);
+    if(self->queue) {
+        __queue_wait(self);
+        free(self->queue->back);
+        free(self->queue);
+        self->queue = nullptr;
+    }
+    if(self->flags & BUFWRITE_BUF_ALLOC) free(self->base);
+    self->base = nullptr;
+    self->cap = 0;
+    if(self->flags & BUFWRITE_FD) {
+        if(~self->flags & BUFWRITE_FH_ATTACH) close(self->fd);
+    }
+    else if(~self->flags & BUFWRITE_MEM) fclose(self->fh);
+    self->fh = nullptr;
+    self->fd = -1;
+    self->flags &= ~BUFWRITE_MEM;
 }
 
 usize atlib_bufwrite_flush(bufwrite_t * self) {
-    return __flush(self);
+    /* There is nowhere for a memory stream to flush to */
+    if(self->flags & BUFWRITE_MEM) return 0;
+
+    const usize n = __flush(self);
+
+    /* A flush still means the bytes have reached the file */
+    if(self->queue) __queue_wait(self);
+    return self->flags & BUFWRITE_ERR ? 0 : n;
+}
+
+/* Writes the pending bytes and then every byte of `iov` straight to the file, without copying them into the buffer */
+static usize __bypass(bufwrite_t * self, const struct iovec * iov, i32 cnt) {
+    if(self->flags & BUFWRITE_ERR) return 0;
+    if(self->queue) {
+        __queue_wait(self);
+        if(self->flags & BUFWRITE_ERR) return 0;
+    }
+
+    const usize n = self->cap - self->to_write;
+    const usize i = __sinkv(self, self->base, n, iov, cnt);
+
+    /* Keep whatever of the pending bytes could not be written at the front of the buffer */
+    if(i < n) {
+        memmove(self->base, self->base + i, n - i);
+        self->next = self->base + (n - i);
+        self->to_write = self->cap - (n - i);
+        return 0;
+    }
+
+    self->next = self->base;
+    self->to_write = self->cap;
+    return i - n;
 }
 
 usize atlib_bufwrite_write(bufwrite_t * restrict self, const void * restrict data, isize n) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
+    atlib_compassert(__is_open(self));
     atlib_compassert(data);
 
-    if(self->to_write < n && __flush(self) == 0) return 0;
-
-    usize i = 0;
-    while(n > self->to_write) {
-        memcpy(self->next, data + i, self->to_write);
-        __flush(self);
-        n -= __ATLIB_BUFWRITE_SIZE;
-        i += __ATLIB_BUFWRITE_SIZE;
+    /* A memory stream grows to fit the whole write at once */
+    if(n <= self->to_write || self->flags & BUFWRITE_MEM) {
+        if(!__room(self, n)) return 0;
+        memcpy(self->next, data, n);
+        self->next += n;
+        self->to_write -= n;
+        return n;
     }
 
-    memcpy(self->next, data + i, n);
-    self->next += n;
-    self->to_write -= n;
+    /* A payload at least as large as the buffer goes to the file in one system call with the pending bytes */
+    if((usize)n >= self->cap) return __bypass(self, &(struct iovec){ .iov_base = (void *)data, .iov_len = n }, 1);
+
+    /* A smaller one tops up the buffer, and the rest starts the next */
+    const usize k = self->to_write;
+    memcpy(self->next, data, k);
+    self->next += k;
+    self->to_write = 0;
+    /* A flush cut short by an error may leave too little room for the rest */
+    if(__flush(self) == 0 || self->flags & BUFWRITE_ERR || (usize)self->to_write < n - k) return k;
+
+    memcpy(self->next, (const char *)data + k, n - k);
+    self->next += n - k;
+    self->to_write -= n - k;
     return n;
 }
 
-usize atlib_bufwrite_writef(bufwrite_t * restrict self, const char * restrict fmt, ...) {
+usize atlib_bufwrite_writev(bufwrite_t * restrict self, const struct iovec * restrict iov, i32 cnt) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
-    atlib_compassert(fmt);
+    atlib_compassert(__is_open(self));
+    atlib_compassert(iov);
 
-    isize n = 0;
-    char c[2];
-    char * m;
+    usize n = 0;
+    for(i32 i = 0; i < cnt; i++) n += iov[i].iov_len;
 
-    va_list ap, bp;
-    va_start(ap, fmt);
-    va_copy(bp, ap);
+    /* Whatever does not fit in the buffer is gathered by the kernel rather than copied */
+    if(n > (usize)self->to_write && ~self->flags & BUFWRITE_MEM) return __bypass(self, iov, cnt);
+    if(!__room(self, n)) return 0;
+
+    for(i32 i = 0; i < cnt; i++) {
+        memcpy(self->next, iov[i].iov_base, iov[i].iov_len);
+        self->next += iov[i].iov_len;
+    }
+    self->to_write -= n;
+    return n;
+}
+
+/* Copies `n` bytes into the buffer, flushing or growing it whenever it fills up; returns bytes copied */
+static usize __put(bufwrite_t * self, const char * src, usize n) {
+    usize i = 0;
+
+    while(i < n) {
+        if(self->to_write == 0 && !__room(self, self->flags & BUFWRITE_MEM ? n - i : 1)) break;
+
+        const usize k = (usize)self->to_write < n - i ? (usize)self->to_write : n - i;
+        memcpy(self->next, src + i, k);
+        self->next += k;
+        self->to_write -= k;
+        i += k;
+    }
+
+    return i;
+}
+
+/* Writes `n` copies of `c`, as `__put` does; returns bytes written */
+static usize __pad(bufwrite_t * self, char c, usize n) {
+    usize i = 0;
+
+    while(i < n) {
+        if(self->to_write == 0 && !__room(self, self->flags & BUFWRITE_MEM ? n - i : 1)) break;
+
+        const usize k = (usize)self->to_write < n - i ? (usize)self->to_write : n - i;
+        memset(self->next, c, k);
+        self->next += k;
+        self->to_write -= k;
+        i += k;
+    }
+
+    return i;
+}
+
+/* Every two-digit number, from "00" to "99", so decimal digits are written two at a time */
+static const char __DIGITS[200] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const u64 __POW10[20] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+    10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+    1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull,
+    10000000000000000000ull,
+};
+
+/* The number of decimal digits of `v`, estimated from its bit length and fixed with one comparison */
+static inline usize __dec_len(u64 v) {
+    v |= 1;
+    const usize d = (64 - __builtin_clzll(v)) * 1233 >> 12;
+    return d + (v >= __POW10[d]);
+}
+
+/* Writes the decimal digits of `v` so that they end right before `end` */
+static inline void __dec_digits(char * end, u64 v) {
+    while(v >= 100) {
+        const u64 q = v / 100;
+        end -= 2;
+        memcpy(end, __DIGITS + (v - q * 100) * 2, 2);
+        v = q;
+    }
+
+    if(v >= 10) memcpy(end - 2, __DIGITS + v * 2, 2);
+    else end[-1] = '0' + v;
+}
+
+/* Flags of a conversion specification */
+#define __FMT_LEFT      1
+#define __FMT_PLUS      2
+#define __FMT_SPACE     4
+#define __FMT_ALT       8
+#define __FMT_ZERO      16
+
+/* The output of a single conversion that is formatted on the stack, before being copied in */
+#define __FMT_TMP       512
+
+/* One conversion specification, i.e. `%-08.3lx` */
+struct __fmt_spec {
+    u32 flags;
+    usize width;
+    isize prec;                     /* -1 when not given */
+    char len[3];                    /* The length modifier, i.e. "ll" */
+    char conv;
+};
+
+/* Writes `body`, preceded by `prefix` and zero-extended to `digits` bytes, padded to the width of `spec`; returns bytes written */
+static usize __fmt_field(bufwrite_t * self, const struct __fmt_spec * spec, const char * prefix, usize plen, const char * body, usize blen, usize digits) {
+    const usize zeros = digits > blen ? digits - blen : 0;
+    const usize len = plen + zeros + blen;
+    const usize fill = spec->width > len ? spec->width - len : 0;
+    usize n = 0;
+
+    /* Zero padding goes between the prefix and the digits, and only applies without a precision */
+    const i32 zero = spec->flags & __FMT_ZERO && !(spec->flags & __FMT_LEFT) && spec->prec < 0 && spec->conv != 's' && spec->conv != 'c';
 
-    /* Find the number of bytes required to format the string */
-    n = vsnprintf(c, 1, fmt, ap);
+    if(!(spec->flags & __FMT_LEFT) && !zero) n += __pad(self, ' ', fill);
+    n += __put(self, prefix, plen);
+    n += __pad(self, '0', zeros + (zero ? fill : 0));
+    n += __put(self, body, blen);
+    if(spec->flags & __FMT_LEFT) n += __pad(self, ' ', fill);
 
-    /* If we can fit the string in the current buffer, do so */
-    if(n < self->to_write) {
-        vsnprintf(self->next, self->to_write, fmt, bp);
+    return n;
+}
+
+/* Formats the integer `v`, negative if `neg` */
+static usize __fmt_int(bufwrite_t * self, const struct __fmt_spec * spec, u64 v, i32 neg) {
+    char digits[24];
+    char * const end = digits + sizeof(digits);
+    char * p = end;
+    char prefix[3];
+    usize plen = 0;
+
+    switch(spec->conv) {
+    case 'p':
+    case 'x':
+        for(; v; v >>= 4) *--p = "0123456789abcdef"[v & 15];
+        break;
+    case 'X':
+        for(; v; v >>= 4) *--p = "0123456789ABCDEF"[v & 15];
+        break;
+    case 'o':
+        for(; v; v >>= 3) *--p = '0' + (v & 7);
+        break;
+    default:
+        if(v) {
+            p = end - __dec_len(v);
+            __dec_digits(end, v);
+        }
+        break;
     }
-    /* If we can fit the string in an empty buffer, flush and do so */
-    else if(n < __ATLIB_BUFWRITE_SIZE && __flush(self)) {
-        vsnprintf(self->buf, __ATLIB_BUFWRITE_SIZE, fmt, bp);
+
+    /* Zero has no digits at a precision of 0, except with `%#o` */
+    usize prec = spec->prec < 0 ? 1 : (usize)spec->prec;
+    if(spec->conv == 'o' && spec->flags & __FMT_ALT && (usize)(end - p) >= prec && (p == end || *p != '0')) prec = end - p + 1;
+
+    if(spec->conv == 'd' || spec->conv == 'i' || spec->conv == 'p') {
+        if(neg) prefix[plen++] = '-';
+        else if(spec->flags & __FMT_PLUS) prefix[plen++] = '+';
+        else if(spec->flags & __FMT_SPACE) prefix[plen++] = ' ';
+    }
+    if((spec->conv == 'x' || spec->conv == 'X') && spec->flags & __FMT_ALT && p != end) {
+        prefix[plen++] = '0';
+        prefix[plen++] = spec->conv;
+    }
+    else if(spec->conv == 'p') {
+        prefix[plen++] = '0';
+        prefix[plen++] = 'x';
     }
-    /*  If we can allocate enough memory and copy the string over, do so */
-    else if((m = malloc(++n))) {
-        vsnprintf(m, n, fmt, bp);
-        usize i = n;
 
-        /* We know writer is reset from previous condition's `__flush` call */
-        while(i > __ATLIB_BUFWRITE_SIZE) {
-            memcpy(self->buf, m + (n - i), __ATLIB_BUFWRITE_SIZE);
-            self->to_write = 0;
-            i -= __ATLIB_BUFWRITE_SIZE;
-            __flush(self);
+    return __fmt_field(self, spec, prefix, plen, p, end - p, prec);
+}
+
+/* Formats what the engine leaves to the C library, with `snprintf`, on the stack whenever it fits */
+#define __FMT_LIBC(self, spec, value) \
+    do { \
+        char f[32], tmp[__FMT_TMP]; \
+        __fmt_rebuild(f, spec); \
+        const int r = snprintf(tmp, sizeof(tmp), f, value); \
+        if(r < 0) break; \
+        if((usize)r < sizeof(tmp)) { \
+            n += __put(self, tmp, r); \
+            break; \
+        } \
+        /* Only huge precisions and wide strings get here; they go straight into the buffer if it can hold them */ \
+        if(__room(self, r + 1)) { \
+            snprintf(self->next, r + 1, f, value); \
+            self->next += r; \
+            self->to_write -= r; \
+            n += r; \
+            break; \
+        } \
+        char * const m = malloc(r + 1); \
+        if(m == NULL) break; \
+        snprintf(m, r + 1, f, value); \
+        n += __put(self, m, r); \
+        free(m); \
+    } while(0)
+
+/* Writes `spec` back out as a specification of the C library, with its width and precision resolved */
+static void __fmt_rebuild(char * f, const struct __fmt_spec * spec) {
+    char * p = f;
+    *p++ = '%';
+    if(spec->flags & __FMT_LEFT) *p++ = '-';
+    if(spec->flags & __FMT_PLUS) *p++ = '+';
+    if(spec->flags & __FMT_SPACE) *p++ = ' ';
+    if(spec->flags & __FMT_ALT) *p++ = '#';
+    if(spec->flags & __FMT_ZERO) *p++ = '0';
+    p += sprintf(p, "%zu", spec->width);
+    if(spec->prec >= 0) p += sprintf(p, ".%zd", spec->prec);
+    for(const char * l = spec->len; *l; l++) *p++ = *l;
+    *p++ = spec->conv;
+    *p = '\0';
+}
+
+/* Reads a decimal number at `*p`, or `*` from the argument list; returns -1 for a negative `*` */
+static isize __fmt_num(const char ** p, va_list * ap) {
+    if(**p == '*') {
+        (*p)++;
+        const int v = va_arg(*ap, int);
+        return v;
+    }
+
+    isize v = 0;
+    for(; **p >= '0' && **p <= '9'; (*p)++) v = v * 10 + (**p - '0');
+    return v;
+}
+
+/* Formats `fmt` straight into the buffer, in one pass, flushing it whenever it fills up; returns bytes written */
+static usize __format(bufwrite_t * self, const char * fmt, va_list * ap) {
+    usize n = 0;
+
+    while(*fmt) {
+        /* Copy everything up to the next conversion as a whole */
+        const char * pct = strchr(fmt, '%');
+        if(pct == NULL) pct = fmt + strlen(fmt);
+        n += __put(self, fmt, pct - fmt);
+        if(*pct == '\0' || self->flags & BUFWRITE_ERR) break;
+
+        const char * const start = pct;
+        const char * p = pct + 1;
+        struct __fmt_spec spec = { .prec = -1 };
+
+        for(;; p++) {
+            if(*p == '-') spec.flags |= __FMT_LEFT;
+            else if(*p == '+') spec.flags |= __FMT_PLUS;
+            else if(*p == ' ') spec.flags |= __FMT_SPACE;
+            else if(*p == '#') spec.flags |= __FMT_ALT;
+            else if(*p == '0') spec.flags |= __FMT_ZERO;
+            else break;
         }
-        memcpy(self->next, m + (n - i), i);
-        self->to_write -= i;
-        self->next += i;
 
-        free(m);
+        /* A negative width from `*` means left-justified */
+        const isize w = __fmt_num(&p, ap);
+        if(w < 0) spec.flags |= __FMT_LEFT;
+        spec.width = w < 0 ? -w : w;
 
-        goto end;
+        if(*p == '.') {
+            p++;
+            spec.prec = __fmt_num(&p, ap);
+            if(spec.prec < -1) spec.prec = -1;
+        }
+
+        usize l = 0;
+        while(l < 2 && *p && strchr("hljztL", *p) && (l == 0 || *p == spec.len[0])) spec.len[l++] = *p++;
+        spec.conv = *p;
+        fmt = *p ? p + 1 : p;
+
+        /* The length modifier, folded into one byte: 'H' for hh, 'q' for ll */
+        const char len = spec.len[1] ? (spec.len[0] == 'h' ? 'H' : 'q') : spec.len[0];
+        u64 u;
+        i64 s;
+
+        switch(spec.conv) {
+        case 'd':
+        case 'i':
+            switch(len) {
+            case 'H': s = (signed char)va_arg(*ap, int); break;
+            case 'h': s = (short)va_arg(*ap, int); break;
+            case 'l': s = va_arg(*ap, long); break;
+            case 'q': case 'L': s = va_arg(*ap, long long); break;
+            case 'j': s = va_arg(*ap, intmax_t); break;
+            case 'z': s = va_arg(*ap, isize); break;
+            case 't': s = va_arg(*ap, ptrdiff_t); break;
+            default: s = va_arg(*ap, int); break;
+            }
+            n += __fmt_int(self, &spec, s < 0 ? -(u64)s : (u64)s, s < 0);
+            break;
+
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            switch(len) {
+            case 'H': u = (unsigned char)va_arg(*ap, unsigned); break;
+            case 'h': u = (unsigned short)va_arg(*ap, unsigned); break;
+            case 'l': u = va_arg(*ap, unsigned long); break;
+            case 'q': case 'L': u = va_arg(*ap, unsigned long long); break;
+            case 'j': u = va_arg(*ap, uintmax_t); break;
+            case 'z': u = va_arg(*ap, usize); break;
+            case 't': u = va_arg(*ap, ptrdiff_t); break;
+            default: u = va_arg(*ap, unsigned); break;
+            }
+            n += __fmt_int(self, &spec, u, 0);
+            break;
+
+        case 'p': {
+            const void * const ptr = va_arg(*ap, void *);
+            if(ptr == NULL) {
+                spec.flags &= ~__FMT_ZERO;
+                n += __fmt_field(self, &spec, "", 0, "(nil)", 5, 0);
+                break;
+            }
+            n += __fmt_int(self, &spec, (usize)ptr, 0);
+            break;
+        }
+
+        case 'c': {
+            if(len == 'l') {
+                __FMT_LIBC(self, &spec, va_arg(*ap, wint_t));
+                break;
+            }
+            const char c = va_arg(*ap, int);
+            n += __fmt_field(self, &spec, "", 0, &c, 1, 0);
+            break;
+        }
+
+        case 's': {
+            if(len == 'l') {
+                __FMT_LIBC(self, &spec, va_arg(*ap, const wchar_t *));
+                break;
+            }
+            const char * str = va_arg(*ap, const char *);
+            if(str == NULL) str = "(null)";
+            const usize k = spec.prec < 0 ? strlen(str) : strnlen(str, spec.prec);
+            n += __fmt_field(self, &spec, "", 0, str, k, 0);
+            break;
+        }
+
+        case 'f': case 'F': case 'e': case 'E':
+        case 'g': case 'G': case 'a': case 'A':
+            if(len == 'L') __FMT_LIBC(self, &spec, va_arg(*ap, long double));
+            else __FMT_LIBC(self, &spec, va_arg(*ap, double));
+            break;
+
+        case 'n':
+            switch(len) {
+            case 'H': *va_arg(*ap, signed char *) = n; break;
+            case 'h': *va_arg(*ap, short *) = n; break;
+            case 'l': *va_arg(*ap, long *) = n; break;
+            case 'q': case 'L': *va_arg(*ap, long long *) = n; break;
+            case 'j': *va_arg(*ap, intmax_t *) = n; break;
+            case 'z': *va_arg(*ap, isize *) = n; break;
+            case 't': *va_arg(*ap, ptrdiff_t *) = n; break;
+            default: *va_arg(*ap, int *) = n; break;
+            }
+            break;
+
+        case '%':
+            n += __put(self, "%", 1);
+            break;
+
+        /* Anything else, positional arguments included, is written out as it is */
+        default:
+            n += __put(self, start, fmt - start);
+            break;
+        }
     }
-    /* Otherwise, don't modify the writer at all */
-    else n = 0;
 
-    self->next += n;
-    self->to_write -= n;
+    return n;
+}
 
-end:
-    va_end(bp);
+usize atlib_bufwrite_writef(bufwrite_t * restrict self, const char * restrict fmt, ...) {
+    atlib_compassert(self);
+    atlib_compassert(__is_open(self));
+    atlib_compassert(fmt);
+
+    va_list ap;
+    va_start(ap, fmt);
+    const usize n = __format(self, fmt, &ap);
     va_end(ap);
+
     return n;
 }
 
 usize atlib_bufwrite_writefv(bufwrite_t * restrict self, const char * restrict fmt, va_list ap) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
+    atlib_compassert(__is_open(self));
     atlib_compassert(fmt);
 
+    /* A va_list parameter may be an array in disguise, so it is copied before its address is taken */
     va_list bp;
     va_copy(bp, ap);
+    const usize n = __format(self, fmt, &bp);
+    va_end(bp);
+
+    return n;
+}
+
+/* Hands the `len` bytes formatted at `p` over to the stream; they are already in place unless `p` is `tmp` */
+static inline usize __commit(bufwrite_t * self, const char * p, const char * tmp, usize len) {
+    if(p == tmp) return __put(self, tmp, len) == len ? len : 0;
+
+    self->next += len;
+    self->to_write -= len;
+    return len;
+}
+
+/* Where a number of at most `n` bytes is formatted: in place when the buffer has room for it, in `tmp` otherwise */
+static inline char * __place(bufwrite_t * self, char * tmp, usize n) {
+    return (usize)self->to_write >= n || __room(self, n) ? self->next : tmp;
+}
+
+usize atlib_bufwrite_write_dec_u64(bufwrite_t * self, u64 v) {
+    atlib_compassert(self);
+    atlib_compassert(__is_open(self));
+
+    char tmp[24];
+    const usize len = __dec_len(v);
+    char * const p = __place(self, tmp, len);
+
+    __dec_digits(p + len, v);
+    return __commit(self, p, tmp, len);
+}
 
-    isize n = 0;
-    char c[2];
-    char * m;
+usize atlib_bufwrite_write_dec_i64(bufwrite_t * self, i64 v) {
+    atlib_compassert(self);
+    atlib_compassert(__is_open(self));
+
+    char tmp[24];
+    const i32 neg = v < 0;
+    const u64 u = neg ? -(u64)v : (u64)v;
+    const usize len = __dec_len(u) + neg;
+    char * const p = __place(self, tmp, len);
+
+    *p = '-';
+    __dec_digits(p + len, u);
+    return __commit(self, p, tmp, len);
+}
+
+usize atlib_bufwrite_write_hex_u64(bufwrite_t * self, u64 v) {
+    atlib_compassert(self);
+    atlib_compassert(__is_open(self));
+
+    char tmp[24];
+    const usize len = (64 - __builtin_clzll(v | 1) + 3) / 4;
+    char * const p = __place(self, tmp, len);
+
+    for(char * q = p + len; q > p; v >>= 4) *--q = "0123456789abcdef"[v & 15];
+    return __commit(self, p, tmp, len);
+}
+
+/*
+ * Shortest round-trip formatting of doubles, after Florian Loitsch's Grisu2 ("Printing Floating-Point
+ * Numbers Quickly and Accurately with Integers", PLDI 2010). A double and the bounds of the interval
+ * rounding to it are scaled by a cached power of ten into 64-bit fixed point, and digits are generated
+ * until they identify the interval. The digits always read back as the same double, and are the
+ * shortest such digits in all but a handful of cases.
+ */
 
-    /* Find the number of bytes required to format the string */
-    n = vsnprintf(c, 1, fmt, ap);
+/* A floating-point number f * 2^e, with a 64-bit significand */
+typedef struct {
+    u64 f;
+    i32 e;
+} __diyfp_t;
 
-    /* If we can fit the string in the current buffer, do so */
-    if(n < self->to_write) {
-        vsnprintf(self->next, self->to_write, fmt, bp);
+/* Normalized 10^k, for k = -348, -340, ..., 340 */
+static const u64 __CACHED_F[87] = {
+    0xfa8fd5a0081c0288, 0xbaaee17fa23ebf76, 0x8b16fb203055ac76, 0xcf42894a5dce35ea,
+    0x9a6bb0aa55653b2d, 0xe61acf033d1a45df, 0xab70fe17c79ac6ca, 0xff77b1fcbebcdc4f,
+    0xbe5691ef416bd60c, 0x8dd01fad907ffc3c, 0xd3515c2831559a83, 0x9d71ac8fada6c9b5,
+    0xea9c227723ee8bcb, 0xaecc49914078536d, 0x823c12795db6ce57, 0xc21094364dfb5637,
+    0x9096ea6f3848984f, 0xd77485cb25823ac7, 0xa086cfcd97bf97f4, 0xef340a98172aace5,
+    0xb23867fb2a35b28e, 0x84c8d4dfd2c63f3b, 0xc5dd44271ad3cdba, 0x936b9fcebb25c996,
+    0xdbac6c247d62a584, 0xa3ab66580d5fdaf6, 0xf3e2f893dec3f126, 0xb5b5ada8aaff80b8,
+    0x87625f056c7c4a8b, 0xc9bcff6034c13053, 0x964e858c91ba2655, 0xdff9772470297ebd,
+    0xa6dfbd9fb8e5b88f, 0xf8a95fcf88747d94, 0xb94470938fa89bcf, 0x8a08f0f8bf0f156b,
+    0xcdb02555653131b6, 0x993fe2c6d07b7fac, 0xe45c10c42a2b3b06, 0xaa242499697392d3,
+    0xfd87b5f28300ca0e, 0xbce5086492111aeb, 0x8cbccc096f5088cc, 0xd1b71758e219652c,
+    0x9c40000000000000, 0xe8d4a51000000000, 0xad78ebc5ac620000, 0x813f3978f8940984,
+    0xc097ce7bc90715b3, 0x8f7e32ce7bea5c70, 0xd5d238a4abe98068, 0x9f4f2726179a2245,
+    0xed63a231d4c4fb27, 0xb0de65388cc8ada8, 0x83c7088e1aab65db, 0xc45d1df942711d9a,
+    0x924d692ca61be758, 0xda01ee641a708dea, 0xa26da3999aef774a, 0xf209787bb47d6b85,
+    0xb454e4a179dd1877, 0x865b86925b9bc5c2, 0xc83553c5c8965d3d, 0x952ab45cfa97a0b3,
+    0xde469fbd99a05fe3, 0xa59bc234db398c25, 0xf6c69a72a3989f5c, 0xb7dcbf5354e9bece,
+    0x88fcf317f22241e2, 0xcc20ce9bd35c78a5, 0x98165af37b2153df, 0xe2a0b5dc971f303a,
+    0xa8d9d1535ce3b396, 0xfb9b7cd9a4a7443c, 0xbb764c4ca7a44410, 0x8bab8eefb6409c1a,
+    0xd01fef10a657842c, 0x9b10a4e5e9913129, 0xe7109bfba19c0c9d, 0xac2820d9623bf429,
+    0x80444b5e7aa7cf85, 0xbf21e44003acdd2d, 0x8e679c2f5e44ff8f, 0xd433179d9c8cb841,
+    0x9e19db92b4e31ba9, 0xeb96bf6ebadf77d9, 0xaf87023b9bf0ee6b,
+};
+
+static const i16 __CACHED_E[87] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+    -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+    -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+    -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+    56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+    694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+    1013, 1039, 1066,
+};
+
+static inline __diyfp_t __diy_mul(__diyfp_t a, __diyfp_t b) {
+    const __uint128_t p = (__uint128_t)a.f * b.f;
+    const u64 h = (u64)(p >> 64) + (((u64)p >> 63) & 1);
+    return (__diyfp_t){ .f = h, .e = a.e + b.e + 64 };
+}
+
+static inline __diyfp_t __diy_norm(__diyfp_t a) {
+    const i32 s = __builtin_clzll(a.f);
+    return (__diyfp_t){ .f = a.f << s, .e = a.e - s };
+}
+
+/* Nudges the last digit down while the digits stay in the interval and get closer to the exact value */
+static inline void __grisu_round(char * buf, usize len, u64 delta, u64 rest, u64 ten_kappa, u64 wp_w) {
+    while(rest < wp_w && delta - rest >= ten_kappa && (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        buf[len - 1]--;
+        rest += ten_kappa;
     }
-    /* If we can fit the string in an empty buffer, flush and do so */
-    else if(n < __ATLIB_BUFWRITE_SIZE && __flush(self)) {
-        vsnprintf(self->buf, __ATLIB_BUFWRITE_SIZE, fmt, bp);
+}
+
+/* Generates the digits of `w` into `buf`, as few as identify it within `delta` of the upper bound `mp`; returns their count */
+static usize __grisu_digits(__diyfp_t w, __diyfp_t mp, u64 delta, char * buf, i32 * k) {
+    const i32 shift = -mp.e;
+    const u64 one = (u64)1 << shift;
+    const u64 wp_w = mp.f - w.f;
+    u32 p1 = mp.f >> shift;
+    u64 p2 = mp.f & (one - 1);
+    i32 kappa = __dec_len(p1);
+    usize len = 0;
+
+    while(kappa > 0) {
+        const u32 div = __POW10[kappa - 1];
+        const u32 d = p1 / div;
+        p1 %= div;
+        if(d || len) buf[len++] = '0' + d;
+        kappa--;
+
+        const u64 rest = ((u64)p1 << shift) + p2;
+        if(rest <= delta) {
+            *k += kappa;
+            __grisu_round(buf, len, delta, rest, (u64)__POW10[kappa] << shift, wp_w);
+            return len;
+        }
     }
-    /*  If we can allocate enough memory and copy the string over, do so */
-    else if((m = malloc(++n))) {
-        vsnprintf(m, n, fmt, bp);
-        usize i = n;
 
-        /* We know writer is reset from previous condition's `__flush` call */
-        while(i > __ATLIB_BUFWRITE_SIZE) {
-            memcpy(self->buf, m + (n - i), __ATLIB_BUFWRITE_SIZE);
-            self->to_write = 0;
-            i -= __ATLIB_BUFWRITE_SIZE;
-            __flush(self);
+    for(;;) {
+        p2 *= 10;
+        delta *= 10;
+        const char d = p2 >> shift;
+        if(d || len) buf[len++] = '0' + d;
+        p2 &= one - 1;
+        kappa--;
+
+        if(p2 < delta) {
+            *k += kappa;
+            __grisu_round(buf, len, delta, p2, one, -kappa < 20 ? wp_w * __POW10[-kappa] : 0);
+            return len;
         }
-        memcpy(self->next, m + (n - i), i);
-        self->to_write -= i;
-        self->next += i;
+    }
+}
+
+/* Writes the shortest digits of the positive, finite `v` into `buf`, so that v = digits * 10^k; returns their count */
+static usize __grisu2(f64 v, char * buf, i32 * k) {
+    u64 bits;
+    memcpy(&bits, &v, sizeof(bits));
+
+    const u64 hidden = (u64)1 << 52;
+    const i32 be = (bits >> 52) & 0x7ff;
+    const u64 frac = bits & (hidden - 1);
+    const __diyfp_t x = be ? (__diyfp_t){ .f = frac | hidden, .e = be - 1075 } : (__diyfp_t){ .f = frac, .e = -1074 };
+
+    /* The bounds of the interval of reals that round to v; narrower below a power of two */
+    const __diyfp_t hi = __diy_norm((__diyfp_t){ .f = (x.f << 1) + 1, .e = x.e - 1 });
+    __diyfp_t lo = x.f == hidden ? (__diyfp_t){ .f = (x.f << 2) - 1, .e = x.e - 2 } : (__diyfp_t){ .f = (x.f << 1) - 1, .e = x.e - 1 };
+    lo.f <<= lo.e - hi.e;
+    lo.e = hi.e;
+
+    /* Pick the cached power that brings the upper bound's exponent into [-60, -32] */
+    const f64 dk = (-61 - hi.e) * 0.30102999566398114 + 347;
+    i32 ck = (i32)dk;
+    if(dk - ck > 0.0) ck++;
+    const usize idx = (ck >> 3) + 1;
+    const __diyfp_t c = { .f = __CACHED_F[idx], .e = __CACHED_E[idx] };
+    *k = 348 - (i32)(idx << 3);
+
+    const __diyfp_t w = __diy_mul(__diy_norm(x), c);
+    __diyfp_t wp = __diy_mul(hi, c);
+    __diyfp_t wm = __diy_mul(lo, c);
+    wm.f++;
+    wp.f--;
+
+    return __grisu_digits(w, wp, wp.f - wm.f, buf, k);
+}
 
-        free(m);
+/* Lays out the `len` digits at `buf`, worth digits * 10^k, as a plain decimal or in scientific notation; returns the new length */
+static usize __prettify(char * buf, usize len, i32 k) {
+    const i32 n = (i32)len + k;     /* 10^(n - 1) <= v < 10^n */
 
-        goto end;
+    /* 1234e2 -> 123400 */
+    if((i32)len <= n && n <= 21) {
+        memset(buf + len, '0', n - len);
+        return n;
     }
-    /* Otherwise, don't modify the writer at all */
-    else n = 0;
 
-    self->next += n;
-    self->to_write -= n;
+    /* 1234e-2 -> 12.34 */
+    if(0 < n && n <= 21) {
+        memmove(buf + n + 1, buf + n, len - n);
+        buf[n] = '.';
+        return len + 1;
+    }
 
-end:
-    va_end(bp);
-    return n;
+    /* 1234e-6 -> 0.001234 */
+    if(-6 < n && n <= 0) {
+        const usize off = 2 - n;
+        memmove(buf + off, buf, len);
+        buf[0] = '0';
+        buf[1] = '.';
+        memset(buf + 2, '0', off - 2);
+        return len + off;
+    }
+
+    /* 1234e30 -> 1.234e33 */
+    usize i = 1;
+    if(len > 1) {
+        memmove(buf + 2, buf + 1, len - 1);
+        buf[1] = '.';
+        i = len + 1;
+    }
+    buf[i++] = 'e';
+
+    i32 e = n - 1;
+    if(e < 0) {
+        buf[i++] = '-';
+        e = -e;
+    }
+    const usize el = __dec_len(e);
+    __dec_digits(buf + i + el, e);
+    return i + el;
 }
 
-void atlib_bufwrite_write_u8(bufwrite_t * self, u8 v) {
+usize atlib_bufwrite_write_f64(bufwrite_t * self, f64 v) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
+    atlib_compassert(__is_open(self));
+
+    char tmp[32];
+    char * const p = __place(self, tmp, sizeof(tmp));
+    usize len = 0;
 
-    if(self->to_write <= 0 && __flush(self) == 0) return;
-    self->to_write--;
-    *self->next++ = v;
+    u64 bits;
+    memcpy(&bits, &v, sizeof(bits));
+    if(bits >> 63) p[len++] = '-';
+
+    if((bits >> 52 & 0x7ff) == 0x7ff) {
+        if(bits & (((u64)1 << 52) - 1)) {
+            memcpy(p, "nan", 3);
+            len = 3;
+        }
+        else {
+            memcpy(p + len, "inf", 3);
+            len += 3;
+        }
+    }
+    else if((bits << 1) == 0) p[len++] = '0';
+    else {
+        i32 k;
+        const usize n = __grisu2(bits >> 63 ? -v : v, p + len, &k);
+        len += __prettify(p + len, n, k);
+    }
+
+    return __commit(self, p, tmp, len);
 }
 
-void atlib_bufwrite_write_u16(bufwrite_t * self, u16 v) {
+i32 __atlib_bufwrite_spill(bufwrite_t * restrict self, const void * restrict src, usize n) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
+    atlib_compassert(__is_open(self));
+
+    if(__room(self, n)) {
+        memcpy(self->next, src, n);
+        self->next += n;
+        self->to_write -= n;
+        return 1;
+    }
 
-    if((usize)self->to_write < sizeof(u16) && __flush(self) < sizeof(u16)) return;
-    self->to_write -= sizeof(u16);
-    *self->next++ = (v >> 8) & UBYTE_MASK;
-    *self->next++ = v & UBYTE_MASK;
+    /* Only a buffer smaller than the value itself gets here, once it has been emptied; write around it */
+    if(self->flags & (BUFWRITE_MEM | BUFWRITE_ERR) || (usize)self->to_write != self->cap) return 0;
+    if(self->queue) __queue_wait(self);
+    return __sink(self, src, n) == n;
 }
 
-void atlib_bufwrite_write_u32(bufwrite_t * self, u32 v) {
+void * __atlib_bufwrite_reserve(bufwrite_t * self, usize n) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
+    atlib_compassert(__is_open(self));
+
+    return __room(self, n) ? self->next : NULL;
+}
 
-    if((usize)self->to_write < sizeof(u32) && __flush(self) < sizeof(u32)) return;
-    self->to_write -= sizeof(u32);
-    *self->next++ = (v >> 24) & UBYTE_MASK;
-    *self->next++ = (v >> 16) & UBYTE_MASK;
-    *self->next++ = (v >> 8) & UBYTE_MASK;
-    *self->next++ = v & UBYTE_MASK;
+/* Encodes `v` as LEB128 into `p`, which has room for 10 bytes; returns the length */
+static inline usize __uvarint_encode(char * p, u64 v) {
+    char * const start = p;
+    for(; v >= 0x80; v >>= 7) *p++ = (v & 0x7f) | 0x80;
+    *p++ = v;
+    return p - start;
 }
 
-void atlib_bufwrite_write_u64(bufwrite_t * self, u64 v) {
+void atlib_bufwrite_write_uvarint(bufwrite_t * self, u64 v) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
+    atlib_compassert(__is_open(self));
 
-    if((usize)self->to_write < sizeof(u64) && __flush(self) < sizeof(u64)) return;
-    self->to_write -= sizeof(u64);
+    if(self->to_write >= 10) {
+        const usize n = __uvarint_encode(self->next, v);
+        self->next += n;
+        self->to_write -= n;
+        return;
+    }
 
-    *self->next++ = (v >> 56) & UBYTE_MASK;
-    *self->next++ = (v >> 48) & UBYTE_MASK;
-    *self->next++ = (v >> 40) & UBYTE_MASK;
-    *self->next++ = (v >> 32) & UBYTE_MASK;
-    *self->next++ = (v >> 24) & UBYTE_MASK;
-    *self->next++ = (v >> 16) & UBYTE_MASK;
-    *self->next++ = (v >> 8) & UBYTE_MASK;
-    *self->next++ = v & UBYTE_MASK;
+    /* Near the end of the buffer, encode aside and copy in what fits after flushing */
+    char tmp[10];
+    const usize n = __uvarint_encode(tmp, v);
+    for(usize i = 0; i < n; i++) atlib_bufwrite_write_u8(self, tmp[i]);
 }
 
-void atlib_bufwrite_write_i8(bufwrite_t * self, i8 v) {
-    atlib_compassert(self); 
-    atlib_compassert(self->fh); 
-    if((usize)self->to_write < sizeof(i8) && __flush(self) < sizeof(i8)) return; 
-    self->to_write -= sizeof(i8);
-    *self->next++ = v;
+void atlib_bufwrite_write_svarint(bufwrite_t * self, i64 v) {
+    atlib_bufwrite_write_uvarint(self, ((u64)v << 1) ^ (u64)(v >> 63));
 }
 
-void atlib_bufwrite_write_i16(bufwrite_t * self, i16 v) {
+/* Whether a value stored in this order must be swapped when written from the host */
+#define __SWAP_BE (ATLIB_ENDIAN != ATLIB_BIG_ENDIAN)
+#define __SWAP_LE (ATLIB_ENDIAN != ATLIB_LITTLE_ENDIAN)
+
+/* Copies `n` values of `size` bytes from `src` into the buffer, swapping each one if asked to; returns values written */
+static usize __write_array(bufwrite_t * self, const void * src, usize n, usize size, i32 swap) {
     atlib_compassert(self);
-    atlib_compassert(self->fh);
-    if((usize)self->to_write < sizeof(i16) && __flush(self) < sizeof(i16)) return;
-    self->to_write -= sizeof(i16);
-    *self->next++ = v >> 8;
-    *self->next++ = v & BYTE_MASK;
+    atlib_compassert(__is_open(self));
+    atlib_compassert(src);
+
+    /* Nothing to convert, so large arrays go straight to the file */
+    if(!swap) return atlib_bufwrite_write(self, src, n * size) / size;
+
+    const char * in = src;
+    usize w = 0;
+
+    /* A memory stream grows to fit the whole array at once */
+    if(self->flags & BUFWRITE_MEM && !__room(self, n * size)) return 0;
+
+    while(w < n && ((usize)self->to_write >= size || __room(self, size))) {
+        usize k = self->to_write / size;
+        if(k > n - w) k = n - w;
+
+        if(size == sizeof(u16)) atlib_bswap16_array(self->next, in, k);
+        else if(size == sizeof(u32)) atlib_bswap32_array(self->next, in, k);
+        else atlib_bswap64_array(self->next, in, k);
+
+        self->next += k * size;
+        self->to_write -= k * size;
+        in += k * size;
+        w += k;
+    }
+
+    /* A buffer smaller than a single value takes each one around it */
+    for(; w < n && self->cap < size; w++, in += size) {
+        u64 v;
+        if(size == sizeof(u16)) atlib_bswap16_array(&v, in, 1);
+        else if(size == sizeof(u32)) atlib_bswap32_array(&v, in, 1);
+        else atlib_bswap64_array(&v, in, 1);
+        if(!__atlib_bufwrite_spill(self, &v, size)) break;
+    }
+
+    return w;
 }
 
-void atlib_bufwrite_write_i32(bufwrite_t * self, i32 v) {
-    atlib_compassert(self);
-    atlib_compassert(self->fh);
-    if((usize)self->to_write < sizeof(i32) && __flush(self) < sizeof(i32)) return;
-    self->to_write -= sizeof(i32);
-    *self->next++ = v >> 24;
-    *self->next++ = (v >> 16) & BYTE_MASK;
-    *self->next++ = (v >> 8) & BYTE_MASK;
-    *self->next++ = v & BYTE_MASK;
+usize atlib_bufwrite_write_u16_array(bufwrite_t * restrict self, const u16 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(u16), __SWAP_BE);
 }
 
-void atlib_bufwrite_write_i64(bufwrite_t * self, i64 v) {
-    atlib_compassert(self);
-    atlib_compassert(self->fh);
-    if((usize)self->to_write < sizeof(i64) && __flush(self) < sizeof(i64)) return;
-    self->to_write -= sizeof(i64);
-    *self->next++ = v >> 56;
-    *self->next++ = (v >> 48) & BYTE_MASK;
-    *self->next++ = (v >> 40) & BYTE_MASK;
-    *self->next++ = (v >> 32) & BYTE_MASK;
-    *self->next++ = (v >> 24) & BYTE_MASK;
-    *self->next++ = (v >> 16) & BYTE_MASK;
-    *self->next++ = (v >> 8) & BYTE_MASK;
-    *self->next++ = v & BYTE_MASK;
+usize atlib_bufwrite_write_u16_array_be(bufwrite_t * restrict self, const u16 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(u16), __SWAP_BE);
+}
+
+usize atlib_bufwrite_write_u16_array_le(bufwrite_t * restrict self, const u16 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(u16), __SWAP_LE);
+}
+
+usize atlib_bufwrite_write_u16_array_native(bufwrite_t * restrict self, const u16 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(u16), 0);
+}
+
+usize atlib_bufwrite_write_u32_array(bufwrite_t * restrict self, const u32 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(u32), __SWAP_BE);
+}
+
+usize atlib_bufwrite_write_u32_array_be(bufwrite_t * restrict self, const u32 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(u32), __SWAP_BE);
+}
+
+usize atlib_bufwrite_write_u32_array_le(bufwrite_t * restrict self, const u32 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(u32), __SWAP_LE);
+}
+
+usize atlib_bufwrite_write_u32_array_native(bufwrite_t * restrict self, const u32 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(u32), 0);
+}
+
+usize atlib_bufwrite_write_u64_array(bufwrite_t * restrict self, const u64 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(u64), __SWAP_BE);
+}
+
+usize atlib_bufwrite_write_u64_array_be(bufwrite_t * restrict self, const u64 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(u64), __SWAP_BE);
+}
+
+usize atlib_bufwrite_write_u64_array_le(bufwrite_t * restrict self, const u64 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(u64), __SWAP_LE);
+}
+
+usize atlib_bufwrite_write_u64_array_native(bufwrite_t * restrict self, const u64 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(u64), 0);
+}
+
+usize atlib_bufwrite_write_f32_array(bufwrite_t * restrict self, const f32 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(f32), __SWAP_BE);
+}
+
+usize atlib_bufwrite_write_f32_array_be(bufwrite_t * restrict self, const f32 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(f32), __SWAP_BE);
+}
+
+usize atlib_bufwrite_write_f32_array_le(bufwrite_t * restrict self, const f32 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(f32), __SWAP_LE);
+}
+
+usize atlib_bufwrite_write_f32_array_native(bufwrite_t * restrict self, const f32 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(f32), 0);
+}
+
+usize atlib_bufwrite_write_f64_array(bufwrite_t * restrict self, const f64 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(f64), __SWAP_BE);
+}
+
+usize atlib_bufwrite_write_f64_array_be(bufwrite_t * restrict self, const f64 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(f64), __SWAP_BE);
+}
+
+usize atlib_bufwrite_write_f64_array_le(bufwrite_t * restrict self, const f64 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(f64), __SWAP_LE);
+}
+
+usize atlib_bufwrite_write_f64_array_native(bufwrite_t * restrict self, const f64 * restrict src, usize n) {
+    return __write_array(self, src, n, sizeof(f64), 0);
 }
@@ -0,0 +1,120 @@
+#include <string.h>
+
+#include "Atlib/io/endian.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+#define __SHUF16 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14
+#define __SHUF32 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+#define __SHUF64 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+
+/* Swaps 16 bytes at a time with one shuffle */
+#define __BSWAP_LOOP(dst, src, bytes, ...) \
+    do { \
+        const __m128i shuf = _mm_setr_epi8(__VA_ARGS__); \
+        for(; bytes >= 16; bytes -= 16, dst += 16, src += 16) { \
+            const __m128i x = _mm_loadu_si128((const __m128i *)src); \
+            _mm_storeu_si128((__m128i *)dst, _mm_shuffle_epi8(x, shuf)); \
+        } \
+    } while(0)
+#elif defined(__SSE2__)
+/* Without pshufb, swap the bytes of each 16-bit word, then reorder the words */
+static inline __m128i __bswap_words(__m128i x) {
+    return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+}
+#endif
+
+#if defined(__AVX2__)
+/* Swaps 32 bytes at a time with one in-lane shuffle; returns the bytes left */
+static usize __bswap_wide(char * dst, const char * src, usize bytes, const __m256i shuf) {
+    for(; bytes >= 32; bytes -= 32, dst += 32, src += 32) {
+        const __m256i x = _mm256_loadu_si256((const __m256i *)src);
+        _mm256_storeu_si256((__m256i *)dst, _mm256_shuffle_epi8(x, shuf));
+    }
+    return bytes;
+}
+#endif
+
+void atlib_bswap16_array(void * d, const void * s, usize n) {
+    char * dst = d;
+    const char * src = s;
+    usize bytes = n * sizeof(u16);
+
+#if defined(__AVX2__)
+    bytes = __bswap_wide(dst, src, bytes, _mm256_setr_epi8(__SHUF16, __SHUF16));
+    dst += n * sizeof(u16) - bytes;
+    src += n * sizeof(u16) - bytes;
+#endif
+#if defined(__SSSE3__) || defined(__AVX2__)
+    __BSWAP_LOOP(dst, src, bytes, __SHUF16);
+#elif defined(__SSE2__)
+    for(; bytes >= 16; bytes -= 16, dst += 16, src += 16) {
+        _mm_storeu_si128((__m128i *)dst, __bswap_words(_mm_loadu_si128((const __m128i *)src)));
+    }
+#endif
+
+    for(u16 v; bytes; bytes -= sizeof(u16), dst += sizeof(u16), src += sizeof(u16)) {
+        memcpy(&v, src, sizeof(u16));
+        v = __builtin_bswap16(v);
+        memcpy(dst, &v, sizeof(u16));
+    }
+}
+
+void atlib_bswap32_array(void * d, const void * s, usize n) {
+    char * dst = d;
+    const char * src = s;
+    usize bytes = n * sizeof(u32);
+
+#if defined(__AVX2__)
+    bytes = __bswap_wide(dst, src, bytes, _mm256_setr_epi8(__SHUF32, __SHUF32));
+    dst += n * sizeof(u32) - bytes;
+    src += n * sizeof(u32) - bytes;
+#endif
+#if defined(__SSSE3__) || defined(__AVX2__)
+    __BSWAP_LOOP(dst, src, bytes, __SHUF32);
+#elif defined(__SSE2__)
+    for(; bytes >= 16; bytes -= 16, dst += 16, src += 16) {
+        const __m128i x = __bswap_words(_mm_loadu_si128((const __m128i *)src));
+        _mm_storeu_si128((__m128i *)dst, _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xB1), 0xB1));
+    }
+#endif
+
+    for(u32 v; bytes; bytes -= sizeof(u32), dst += sizeof(u32), src += sizeof(u32)) {
+        memcpy(&v, src, sizeof(u32));
+        v = __builtin_bswap32(v);
+        memcpy(dst, &v, sizeof(u32));
+    }
+}
+
+void atlib_bswap64_array(void * d, const void * s, usize n) {
+    char * dst = d;
+    const char * src = s;
+    usize bytes = n * sizeof(u64);
+
+#if defined(__AVX2__)
+    bytes = __bswap_wide(dst, src, bytes, _mm256_setr_epi8(__SHUF64, __SHUF64));
+    dst += n * sizeof(u64) - bytes;
+    src += n * sizeof(u64) - bytes;
+#endif
+#if defined(__SSSE3__) || defined(__AVX2__)
+    __BSWAP_LOOP(dst, src, bytes, __SHUF64);
+#elif defined(__SSE2__)
+    for(; bytes >= 16; bytes -= 16, dst += 16, src += 16) {
+        const __m128i x = __bswap_words(_mm_loadu_si128((const __m128i *)src));
+        _mm_storeu_si128((__m128i *)dst, _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0x1B), 0x1B));
+    }
+#endif
+
+    for(u64 v; bytes; bytes -= sizeof(u64), dst += sizeof(u64), src += sizeof(u64)) {
+        memcpy(&v, src, sizeof(u64));
+        v = __builtin_bswap64(v);
+        memcpy(dst, &v, sizeof(u64));
+    }
+}
@@ -0,0 +1,155 @@
+#define _GNU_SOURCE
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include "Atlib/io/uring.h"
+#include "Atlib/error.h"
+
+static inline i32 __setup(u32 entries, struct io_uring_params * p) {
+    return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static inline i32 __enter(i32 fd, u32 submit, u32 wait, u32 flags) {
+    return syscall(__NR_io_uring_enter, fd, submit, wait, flags, NULL, 0);
+}
+
+/* Hands out every completion the kernel has posted to the operation it belongs to */
+static void __reap(uring_t * self) {
+    struct io_uring_cqe * const cqes = self->cqes;
+    const u32 tail = __atomic_load_n(self->cq_tail, __ATOMIC_ACQUIRE);
+    u32 head = *self->cq_head;
+
+    for(; head != tail; head++) {
+        const struct io_uring_cqe * cqe = &cqes[head & self->cq_mask];
+        struct __atlib_uring_op * op = (struct __atlib_uring_op *)(usize)cqe->user_data;
+        op->res = cqe->res;
+        op->done = 1;
+    }
+    __atomic_store_n(self->cq_head, head, __ATOMIC_RELEASE);
+}
+
+uring_t * atlib_uring_open(uring_t * self, u32 entries) {
+    atlib_compassert(self);
+    atlib_compassert(entries > 0);
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    if((self->fd = __setup(entries, &p)) < 0) return NULL;
+
+    /* Streams read and write at the file position, and rely on completions never being dropped */
+    if(~p.features & IORING_FEAT_RW_CUR_POS || ~p.features & IORING_FEAT_NODROP) goto map_err;
+
+    self->sq_len = p.sq_off.array + p.sq_entries * sizeof(u32);
+    self->cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if(p.features & IORING_FEAT_SINGLE_MMAP && self->cq_len > self->sq_len) self->sq_len = self->cq_len;
+
+    self->sq_map = mmap(NULL, self->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, self->fd, IORING_OFF_SQ_RING);
+    if(self->sq_map == MAP_FAILED) goto map_err;
+
+    if(p.features & IORING_FEAT_SINGLE_MMAP) {
+        self->cq_map = self->sq_map;
+        self->cq_len = self->sq_len;
+    }
+    else {
+        self->cq_map = mmap(NULL, self->cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, self->fd, IORING_OFF_CQ_RING);
+        if(self->cq_map == MAP_FAILED) goto cq_err;
+    }
+
+    self->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    self->sqes = mmap(NULL, self->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, self->fd, IORING_OFF_SQES);
+    if(self->sqes == MAP_FAILED) goto sqes_err;
+
+    char * const sq = self->sq_map;
+    char * const cq = self->cq_map;
+    self->sq_head = (u32 *)(sq + p.sq_off.head);
+    self->sq_tail = (u32 *)(sq + p.sq_off.tail);
+    self->sq_array = (u32 *)(sq + p.sq_off.array);
+    self->sq_mask = *(u32 *)(sq + p.sq_off.ring_mask);
+    self->cq_head = (u32 *)(cq + p.cq_off.head);
+    self->cq_tail = (u32 *)(cq + p.cq_off.tail);
+    self->cq_mask = *(u32 *)(cq + p.cq_off.ring_mask);
+    self->cqes = cq + p.cq_off.cqes;
+    self->entries = p.sq_entries;
+    self->queued = 0;
+    return self;
+
+sqes_err:
+    if(self->cq_map != self->sq_map) munmap(self->cq_map, self->cq_len);
+cq_err:
+    munmap(self->sq_map, self->sq_len);
+map_err:
+    close(self->fd);
+    self->fd = -1;
+    return NULL;
+}
+
+void atlib_uring_close(uring_t * self) {
+    atlib_compassert(self);
+    atlib_compassert(self->fd >= 0);
+
+    munmap(self->sqes, self->sqes_len);
+    if(self->cq_map != self->sq_map) munmap(self->cq_map, self->cq_len);
+    munmap(self->sq_map, self->sq_len);
+    close(self->fd);
+    self->fd = -1;
+}
+
+u32 atlib_uring_submit(uring_t * self) {
+    atlib_compassert(self);
+
+    if(self->queued == 0) return 0;
+
+    i32 r;
+    do { r = __enter(self->fd, self->queued, 0, 0); } while(r < 0 && errno == EINTR);
+    if(r < 0) return 0;
+
+    self->queued -= r;
+    return r;
+}
+
+i32 __atlib_uring_queue(uring_t * self, struct __atlib_uring_op * op, i32 write, i32 fd, void * buf, u32 n) {
+    atlib_compassert(self);
+
+    /* Make room by handing the full queue to the kernel, which consumes it before returning */
+    const u32 tail = *self->sq_tail;
+    if(tail - __atomic_load_n(self->sq_head, __ATOMIC_ACQUIRE) == self->entries && atlib_uring_submit(self) == 0) return 0;
+
+    const u32 i = tail & self->sq_mask;
+    struct io_uring_sqe * sqe = &((struct io_uring_sqe *)self->sqes)[i];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (u64)(usize)buf;
+    sqe->len = n;
+    sqe->off = (u64)-1;
+    sqe->user_data = (u64)(usize)op;
+
+    op->done = 0;
+    self->sq_array[i] = i;
+    __atomic_store_n(self->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    self->queued++;
+    return 1;
+}
+
+void __atlib_uring_wait(uring_t * self, struct __atlib_uring_op * op) {
+    atlib_compassert(self);
+    atlib_compassert(op);
+
+    for(;;) {
+        __reap(self);
+        if(op->done) return;
+
+        /* Submitting and waiting share one call; other streams' operations go along */
+        const i32 r = __enter(self->fd, self->queued, 1, IORING_ENTER_GETEVENTS);
+        if(r >= 0) self->queued -= r;
+        else if(errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            op->res = -errno;
+            op->done = 1;
+            return;
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#include <Atlib.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+
+#define N 5000
+
+static u64 __src[N];
+static u64 __dst[N];
+
+/* Writes each array writer's output for @c n values, in the order @ref __read_arrays reads them back */
+static void __write_arrays(bufwrite_t * bw, usize n) {
+    atlib_bufwrite_write_u8(bw, 0xa5);
+    test_check(atlib_bufwrite_write_u16_array(bw, (const u16 *)__src, n) == n);
+    test_check(atlib_bufwrite_write_u16_array_be(bw, (const u16 *)__src, n) == n);
+    test_check(atlib_bufwrite_write_u16_array_le(bw, (const u16 *)__src, n) == n);
+    test_check(atlib_bufwrite_write_u32_array_be(bw, (const u32 *)__src, n) == n);
+    test_check(atlib_bufwrite_write_u32_array_le(bw, (const u32 *)__src, n) == n);
+    test_check(atlib_bufwrite_write_u64_array(bw, __src, n) == n);
+    test_check(atlib_bufwrite_write_u64_array_le(bw, __src, n) == n);
+    test_check(atlib_bufwrite_write_u64_array_native(bw, __src, n) == n);
+    test_check(atlib_bufwrite_write_f32_array_be(bw, (const f32 *)__src, n) == n);
+    test_check(atlib_bufwrite_write_f64_array_le(bw, (const f64 *)__src, n) == n);
+}
+
+static void __read_arrays(bufread_t * br, usize n) {
+    test_check(atlib_bufread_read_u8(br) == 0xa5);
+
+    /* Read back as raw integers, so that every float bit pattern compares exactly */
+    test_check(atlib_bufread_read_u16_array_be(br, (u16 *)__dst, n) == n && memcmp(__dst, __src, n * 2) == 0);
+    test_check(atlib_bufread_read_u16_array_be(br, (u16 *)__dst, n) == n && memcmp(__dst, __src, n * 2) == 0);
+    test_check(atlib_bufread_read_u16_array_le(br, (u16 *)__dst, n) == n && memcmp(__dst, __src, n * 2) == 0);
+    test_check(atlib_bufread_read_u32_array_be(br, (u32 *)__dst, n) == n && memcmp(__dst, __src, n * 4) == 0);
+    test_check(atlib_bufread_read_u32_array_le(br, (u32 *)__dst, n) == n && memcmp(__dst, __src, n * 4) == 0);
+    test_check(atlib_bufread_read_u64_array_be(br, __dst, n) == n && memcmp(__dst, __src, n * 8) == 0);
+    test_check(atlib_bufread_read_u64_array_le(br, __dst, n) == n && memcmp(__dst, __src, n * 8) == 0);
+    test_check(atlib_bufread_read_u64_array(br, __dst, n) == n && memcmp(__dst, __src, n * 8) == 0);
+    test_check(atlib_bufread_read_u32_array_be(br, (u32 *)__dst, n) == n && memcmp(__dst, __src, n * 4) == 0);
+    test_check(atlib_bufread_read_u64_array_le(br, __dst, n) == n && memcmp(__dst, __src, n * 8) == 0);
+}
+
+int main(void) {
+    for(usize k = 0; k < N; k++) __src[k] = ((u64)rand() << 33) ^ ((u64)rand() << 7) ^ (u64)rand();
+
+    /* The default array writers are big-endian */
+    bufwrite_t bw;
+    usize len;
+    const u32 v = 0x01020304;
+    atlib_bufwrite_memopen(&bw);
+    atlib_bufwrite_write_u32_array(&bw, &v, 1);
+    test_check(memcmp(atlib_bufwrite_membuf(&bw, &len), "\1\2\3\4", 4) == 0 && len == 4);
+    atlib_bufwrite_close(&bw);
+
+    /* Writer buffers smaller than one value, smaller than the array, and larger than it; read back
+       natively, through a buffer that holds at least one value */
+    const usize counts[] = {0, 1, 3, 17, N};
+    const usize caps[] = {7, 100, 1 << 17};
+    for(usize c = 0; c < sizeof(caps) / sizeof(*caps); c++) {
+        for(usize m = 0; m < 2; m++) {
+            remove(test_file("array.bin"));
+            if(m) atlib_bufwrite_memopen(&bw);
+            else test_check(atlib_bufwrite_open_ex(&bw, test_file("array.bin"), BUFWRITE_FD));
+            atlib_bufwrite_setbuf(&bw, NULL, caps[c]);
+            for(usize k = 0; k < sizeof(counts) / sizeof(*counts); k++) __write_arrays(&bw, counts[k]);
+
+            bufread_t br;
+            char * mem = NULL;
+            if(m) {
+                mem = atlib_bufwrite_memtake(&bw, &len);
+                atlib_bufwrite_close(&bw);
+                atlib_bufread_memopen(&br, mem, len, BUFREAD_READ_NATIVE);
+            }
+            else {
+                atlib_bufwrite_close(&bw);
+                test_check(atlib_bufread_open(&br, test_file("array.bin"), BUFREAD_READ_NATIVE));
+                atlib_bufread_setbuf(&br, NULL, caps[c] < 64 ? 64 : caps[c]);
+            }
+
+            for(usize k = 0; k < sizeof(counts) / sizeof(*counts); k++) __read_arrays(&br, counts[k]);
+            test_check(atlib_bufread_read_u8(&br) == 0 && atlib_bufread_eof(&br));
+            atlib_bufread_close(&br);
+            free(mem);
+        }
+    }
+
+    remove(test_file("array.bin"));
+    return test_done();
+}
@@ -0,0 +1,109 @@
+#include <Atlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "test.h"
+
+#define WIDE 40
+
+static char __text[4096];
+static usize __len = 0;
+
+/* Expected fields, one record per row, quotes already removed from their views */
+static char __exp[5][WIDE + 1][32];
+static usize __nexp[5];
+
+static void __check_records(bufread_t * br, char quote) {
+    bufcsv_t csv;
+    test_check(atlib_bufcsv_open(&csv, br, ',', quote));
+
+    usize r = 0;
+    while(atlib_bufcsv_next(&csv) > 0) {
+        test_check(r < 5 && csv.nfields == __nexp[r]);
+        if(r >= 5 || csv.nfields != __nexp[r]) break;
+
+        usize bad = 0;
+        for(usize k = 0; k < csv.nfields; k++) {
+            const usize len = strlen(__exp[r][k]);
+            bad += csv.fields[k].len != len || memcmp(csv.fields[k].ptr, __exp[r][k], len) != 0;
+        }
+        test_check(bad == 0);
+
+        if(r == 1) {
+            char plain[32];
+            const usize len = atlib_bufcsv_unquote(&csv, csv.fields[1], plain);
+            test_check(len == 12 && memcmp(plain, "say \"hi\" ok!", 12) == 0);
+        }
+        r++;
+    }
+    test_check(r == 5);
+    test_check(atlib_bufcsv_next(&csv) == 0);
+    atlib_bufcsv_close(&csv);
+}
+
+int main(void) {
+    __len += sprintf(__text + __len, "a,b,c\n");
+    strcpy(__exp[0][0], "a"); strcpy(__exp[0][1], "b"); strcpy(__exp[0][2], "c");
+    __nexp[0] = 3;
+
+    /* Quoted delimiter, doubled quotes, a trailing empty field, and a CRLF ending */
+    __len += sprintf(__text + __len, "\"x,y\",\"say \"\"hi\"\" ok!\",\r\n");
+    strcpy(__exp[1][0], "x,y"); strcpy(__exp[1][1], "say \"\"hi\"\" ok!"); strcpy(__exp[1][2], "");
+    __nexp[1] = 3;
+
+    /* An empty line is one empty field */
+    __len += sprintf(__text + __len, "\n");
+    __nexp[2] = 1;
+
+    /* A record many 64-byte blocks long, with a newline inside quotes */
+    for(usize k = 0; k < WIDE; k++) {
+        if(k == WIDE / 2) {
+            __len += sprintf(__text + __len, "\"two\nlines\",");
+            strcpy(__exp[3][k], "two\nlines");
+            continue;
+        }
+        __len += sprintf(__text + __len, "field%02zu,", k);
+        sprintf(__exp[3][k], "field%02zu", k);
+    }
+    __len += sprintf(__text + __len, "end\n");
+    strcpy(__exp[3][WIDE], "end");
+    __nexp[3] = WIDE + 1;
+
+    /* The last record needs no newline */
+    __len += sprintf(__text + __len, "last,\"q\"");
+    strcpy(__exp[4][0], "last"); strcpy(__exp[4][1], "q");
+    __nexp[4] = 2;
+
+    bufread_t br;
+    atlib_bufread_memopen(&br, __text, __len, 0);
+    __check_records(&br, '"');
+    atlib_bufread_close(&br);
+
+    /* Records straddling refills are scanned again, and the one longer than the buffer grows it */
+    FILE * fh = fopen(test_file("csv.txt"), "w");
+    fwrite(__text, 1, __len, fh);
+    fclose(fh);
+
+    const usize caps[] = {7, 64, 100, 4096};
+    for(usize k = 0; k < sizeof(caps) / sizeof(*caps); k++) {
+        test_check(atlib_bufread_open(&br, test_file("csv.txt"), BUFREAD_FD));
+        atlib_bufread_setbuf(&br, NULL, caps[k]);
+        __check_records(&br, '"');
+        atlib_bufread_close(&br);
+    }
+
+    /* Without quoting, quotes are plain bytes and a quoted delimiter splits the field */
+    bufcsv_t csv;
+    const char tsv[] = "\"a\tb\"\t\"c\"\n";
+    atlib_bufread_memopen(&br, tsv, sizeof(tsv) - 1, 0);
+    atlib_bufcsv_open(&csv, &br, '\t', '\0');
+    test_check(atlib_bufcsv_next(&csv) == 1);
+    test_check(csv.nfields == 3);
+    test_check(csv.fields[0].len == 2 && memcmp(csv.fields[0].ptr, "\"a", 2) == 0);
+    test_check(csv.fields[2].len == 3 && memcmp(csv.fields[2].ptr, "\"c\"", 3) == 0);
+    test_check(atlib_bufcsv_next(&csv) == 0);
+    atlib_bufcsv_close(&csv);
+    atlib_bufread_close(&br);
+
+    remove(test_file("csv.txt"));
+    return test_done();
+}
@@ -0,0 +1,108 @@
+#include <Atlib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "test.h"
+
+static u64 __rand64(void) {
+    return ((u64)rand() << 42) ^ ((u64)rand() << 21) ^ (u64)rand() ^ ((u64)rand() << 62);
+}
+
+/* Checks that the last write to the memory stream @c bw was @c n bytes and reads @c exp */
+static int __wrote(bufwrite_t * bw, usize n, const char * exp) {
+    usize len;
+    const char * out = atlib_bufwrite_membuf(bw, &len);
+    const int ok = n == len && len == strlen(exp) && memcmp(out, exp, len) == 0;
+    atlib_bufwrite_memreset(bw);
+    return ok;
+}
+
+int main(void) {
+    bufwrite_t bw;
+    char exp[64];
+    atlib_bufwrite_memopen(&bw);
+
+    /* Every digit count, the powers of ten on both sides, and the extremes */
+    usize bad = 0;
+    for(usize k = 0; k < 20000; k++) {
+        u64 u = __rand64() >> (k % 64);
+        if(k < 40) {
+            u = 1;
+            for(usize d = 0; d < k / 2; d++) u *= 10;
+            u -= k % 2;
+        }
+        if(k == 40) u = UINT64_MAX;
+
+        snprintf(exp, sizeof(exp), "%llu", (unsigned long long)u);
+        bad += !__wrote(&bw, atlib_bufwrite_write_dec_u64(&bw, u), exp);
+
+        const i64 s = k == 41 ? INT64_MIN : (k % 2 ? -(i64)(u >> 1) : (i64)(u >> 1));
+        snprintf(exp, sizeof(exp), "%lld", (long long)s);
+        bad += !__wrote(&bw, atlib_bufwrite_write_dec_i64(&bw, s), exp);
+
+        snprintf(exp, sizeof(exp), "%llx", (unsigned long long)u);
+        bad += !__wrote(&bw, atlib_bufwrite_write_hex_u64(&bw, u), exp);
+    }
+    test_check(bad == 0);
+
+    /* The shortest form, in the notation the value's range calls for */
+    const struct { f64 v; const char * text; } fixed[] = {
+        {0.1, "0.1"}, {0.3, "0.3"}, {1.0, "1"}, {1500.0, "1500"}, {123.456, "123.456"},
+        {0.00025, "0.00025"}, {1e-6, "0.000001"}, {2.5e-7, "2.5e-7"}, {1e21, "1e21"}, {1.5e21, "1.5e21"},
+        {0.0, "0"}, {-0.0, "-0"}, {INFINITY, "inf"}, {-INFINITY, "-inf"}, {NAN, "nan"},
+    };
+    for(usize k = 0; k < sizeof(fixed) / sizeof(*fixed); k++) {
+        test_check(__wrote(&bw, atlib_bufwrite_write_f64(&bw, fixed[k].v), fixed[k].text));
+    }
+
+    /* Any bit pattern, decimal fraction, or scaled integer reads back as the same double */
+    bad = 0;
+    const f64 edges[] = {5e-324, 2.2250738585072014e-308, 1.7976931348623157e308, 9007199254740993.0};
+    for(usize k = 0; k < 100000; k++) {
+        f64 v;
+        const u64 bits = __rand64();
+        if(k % 3 == 0) memcpy(&v, &bits, sizeof(v));
+        else if(k % 3 == 1) v = (f64)(bits % 1000000) / 1000;
+        else v = ldexp((f64)(bits >> 11), (int)(bits % 200) - 100);
+        if(k < sizeof(edges) / sizeof(*edges)) v = edges[k];
+        if(isnan(v)) continue;
+
+        const usize n = atlib_bufwrite_write_f64(&bw, v);
+        usize len;
+        const char * out = atlib_bufwrite_membuf(&bw, &len);
+        char text[64];
+        if(n == 0 || n != len || len >= sizeof(text)) {
+            bad++;
+            atlib_bufwrite_memreset(&bw);
+            continue;
+        }
+        memcpy(text, out, len);
+        text[len] = '\0';
+        const f64 back = strtod(text, NULL);
+        bad += memcmp(&back, &v, sizeof(v)) != 0;
+        atlib_bufwrite_memreset(&bw);
+    }
+    test_check(bad == 0);
+    atlib_bufwrite_close(&bw);
+
+    /* Numbers longer than the whole buffer still come out in one piece */
+    remove(test_file("numfmt.txt"));
+    test_check(atlib_bufwrite_open_ex(&bw, test_file("numfmt.txt"), BUFWRITE_FD));
+    atlib_bufwrite_setbuf(&bw, NULL, 5);
+    atlib_bufwrite_write_dec_u64(&bw, 12345678901234ull);
+    atlib_bufwrite_write_f64(&bw, -1.2345e-300);
+    atlib_bufwrite_write_dec_i64(&bw, -7);
+    atlib_bufwrite_write_hex_u64(&bw, 0xdeadbeefcafeull);
+    atlib_bufwrite_close(&bw);
+
+    char got[64] = {0};
+    FILE * fh = fopen(test_file("numfmt.txt"), "rb");
+    test_check(fread(got, 1, sizeof(got) - 1, fh) == 40);
+    fclose(fh);
+    test_check(strcmp(got, "12345678901234-1.2345e-300-7deadbeefcafe") == 0);
+
+    remove(test_file("numfmt.txt"));
+    return test_done();
+}
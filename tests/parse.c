@@ -0,0 +1,79 @@
+#include <Atlib.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "test.h"
+
+static const char __text[] =
+    "0 18446744073709551615 007\n"
+    "-9223372036854775808 +42 -0\r\n"
+    "3.25 -1e-300 .5 6. 1.7976931348623157e308 inf -nan 0.1\t"
+    "18446744073709551616 x 12";
+
+static void __check_stream(bufread_t * br) {
+    u64 u;
+    i64 i;
+    f64 f;
+
+    test_check(atlib_bufread_parse_u64(br, &u) == 1 && u == 0);
+    test_check(atlib_bufread_parse_u64(br, &u) == 1 && u == UINT64_MAX);
+    test_check(atlib_bufread_parse_u64(br, &u) == 1 && u == 7);
+
+    test_check(atlib_bufread_parse_i64(br, &i) == 1 && i == INT64_MIN);
+    test_check(atlib_bufread_parse_i64(br, &i) == 1 && i == 42);
+    test_check(atlib_bufread_parse_i64(br, &i) == 1 && i == 0);
+
+    const char * floats[] = {"3.25", "-1e-300", ".5", "6.", "1.7976931348623157e308", "inf", "-nan", "0.1"};
+    for(usize k = 0; k < sizeof(floats) / sizeof(*floats); k++) {
+        const f64 exp = strtod(floats[k], NULL);
+        test_check(atlib_bufread_parse_f64(br, &f) == 1);
+        test_check(isnan(exp) ? isnan(f) : memcmp(&f, &exp, sizeof(f)) == 0);
+    }
+
+    /* Out of range, then not a number: the text is left in place */
+    test_check(atlib_bufread_parse_u64(br, &u) == -1);
+    const usize pos = atlib_bufread_pos(br);
+    test_check(atlib_bufread_parse_i64(br, &i) == -1);
+    test_check(atlib_bufread_pos(br) == pos + 1);
+    atlib_bufread_skip(br, 1);
+
+    test_check(atlib_bufread_parse_u64(br, &u) == 1 && u == 12);
+    test_check(atlib_bufread_parse_u64(br, &u) == 0);
+}
+
+int main(void) {
+    FILE * fh = fopen(test_file("parse.txt"), "w");
+    fputs(__text, fh);
+    fclose(fh);
+
+    /* A tiny buffer splits numbers across refills; a mapping never does */
+    const u32 flags[] = {0, BUFREAD_FD, BUFREAD_MMAP};
+    for(usize k = 0; k < sizeof(flags) / sizeof(*flags); k++) {
+        bufread_t br;
+        test_check(atlib_bufread_open(&br, test_file("parse.txt"), flags[k]));
+        if(!(flags[k] & BUFREAD_MMAP)) atlib_bufread_setbuf(&br, NULL, 16);
+        __check_stream(&br);
+        atlib_bufread_close(&br);
+    }
+
+    bufread_t br;
+    atlib_bufread_memopen(&br, __text, sizeof(__text) - 1, 0);
+    __check_stream(&br);
+    atlib_bufread_close(&br);
+
+    /* A run of number characters longer than any number is rejected without growing the buffer */
+    fh = fopen(test_file("parse.txt"), "w");
+    for(usize k = 0; k < 100000; k++) fputc('1', fh);
+    fclose(fh);
+
+    f64 f;
+    atlib_bufread_open(&br, test_file("parse.txt"), 0);
+    atlib_bufread_setbuf(&br, NULL, 4096);
+    test_check(atlib_bufread_parse_f64(&br, &f) == -1);
+    test_check(br.cap == 4096);
+    atlib_bufread_close(&br);
+
+    remove(test_file("parse.txt"));
+    return test_done();
+}
@@ -0,0 +1,126 @@
+#include <Atlib.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+
+#define N 1000
+
+/* Fits in 16 bytes on both sides, so it may take the one-shuffle path */
+typedef struct { u32 id; i16 temp; u8 flags; f64 price; } tick_t;
+
+/* Too wide to shuffle, with a gap in the record and a member no field touches */
+typedef struct { u8 a; u32 b; char name[5]; i64 c; u16 keep; } wide_t;
+
+static u8 __data[N * 21 + 5];
+
+static u64 __be(const u8 * p, usize n) { u64 v = 0; for(usize k = 0; k < n; k++) v = v << 8 | p[k]; return v; }
+static u64 __le(const u8 * p, usize n) { u64 v = 0; for(usize k = n; k > 0; k--) v = v << 8 | p[k - 1]; return v; }
+
+static const bufrecord_field_t __tick[] = {
+    BUFRECORD_FIELD(BUFRECORD_F64, BUFRECORD_LE, 8, tick_t, price),
+    BUFRECORD_FIELD(BUFRECORD_U32, BUFRECORD_LE, 0, tick_t, id),
+    BUFRECORD_FIELD(BUFRECORD_I16, BUFRECORD_BE, 4, tick_t, temp),
+    BUFRECORD_FIELD(BUFRECORD_U8, BUFRECORD_NATIVE, 6, tick_t, flags),
+};
+
+static const bufrecord_field_t __wide[] = {
+    BUFRECORD_FIELD(BUFRECORD_U8, BUFRECORD_BE, 0, wide_t, a),
+    BUFRECORD_FIELD(BUFRECORD_U32, BUFRECORD_LE, 1, wide_t, b),
+    BUFRECORD_FIELD(BUFRECORD_BYTES, BUFRECORD_NATIVE, 5, wide_t, name),
+    BUFRECORD_FIELD(BUFRECORD_I64, BUFRECORD_BE, 12, wide_t, c),
+};
+
+static tick_t __ticks[N];
+static wide_t __wides[N];
+
+static void __check_ticks(const u8 * rec, usize n) {
+    usize bad = 0;
+    for(usize k = 0; k < n; k++, rec += 16) {
+        const u64 price = __le(rec + 8, 8);
+        bad += __ticks[k].id != __le(rec, 4) || __ticks[k].temp != (i16)__be(rec + 4, 2);
+        bad += __ticks[k].flags != rec[6] || memcmp(&__ticks[k].price, &price, 8) != 0;
+    }
+    test_check(bad == 0);
+}
+
+static void __check_wides(const u8 * rec, usize n) {
+    usize bad = 0;
+    for(usize k = 0; k < n; k++, rec += 21) {
+        bad += __wides[k].a != rec[0] || __wides[k].b != __le(rec + 1, 4);
+        bad += memcmp(__wides[k].name, rec + 5, 5) != 0 || __wides[k].c != (i64)__be(rec + 12, 8);
+        bad += __wides[k].keep != (u16)k;
+    }
+    test_check(bad == 0);
+}
+
+int main(void) {
+    for(usize k = 0; k < sizeof(__data); k++) __data[k] = (u8)rand();
+    for(usize k = 0; k < N; k++) __wides[k].keep = (u16)k;
+
+    bufrecord_t tick, wide, bad;
+    test_check(atlib_bufrecord_compile(&tick, __tick, 4, 16, sizeof(tick_t)));
+    test_check(atlib_bufrecord_compile(&wide, __wide, 4, 21, sizeof(wide_t)));
+
+    /* Overlapping fields, a width that differs from the member's, and a field past the record */
+    const bufrecord_field_t overlap[] = {
+        BUFRECORD_FIELD(BUFRECORD_U32, BUFRECORD_BE, 0, tick_t, id),
+        BUFRECORD_FIELD(BUFRECORD_I16, BUFRECORD_BE, 2, tick_t, temp),
+    };
+    const bufrecord_field_t width[] = { BUFRECORD_FIELD(BUFRECORD_U16, BUFRECORD_BE, 0, tick_t, id) };
+    const bufrecord_field_t past[] = { BUFRECORD_FIELD(BUFRECORD_F64, BUFRECORD_BE, 10, tick_t, price) };
+    test_check(atlib_bufrecord_compile(&bad, overlap, 2, 16, sizeof(tick_t)) == NULL);
+    test_check(atlib_bufrecord_compile(&bad, width, 1, 16, sizeof(tick_t)) == NULL);
+    test_check(atlib_bufrecord_compile(&bad, past, 1, 16, sizeof(tick_t)) == NULL);
+
+    /* A buffer smaller than a record still decodes it; a trailing partial record is left unread */
+    bufread_t br;
+    const usize caps[] = {0, 7, 100};
+    for(usize m = 0; m < sizeof(caps) / sizeof(*caps); m++) {
+        FILE * fh = fopen(test_file("record.bin"), "wb");
+        fwrite(__data, 1, sizeof(__data), fh);
+        fclose(fh);
+
+        test_check(atlib_bufread_open(&br, test_file("record.bin"), caps[m] ? BUFREAD_FD : BUFREAD_MMAP));
+        if(caps[m]) atlib_bufread_setbuf(&br, NULL, caps[m]);
+        usize got = 0, n;
+        while(got < N) {
+            const usize want = 1 + got % 300 < N - got ? 1 + got % 300 : N - got;
+            if((n = atlib_bufrecord_decode(&tick, &br, __ticks + got, want)) == 0) break;
+            got += n;
+        }
+        test_check(got == N);
+        __check_ticks(__data, N);
+        atlib_bufread_close(&br);
+
+        test_check(atlib_bufread_open(&br, test_file("record.bin"), caps[m] ? BUFREAD_FD : BUFREAD_MMAP));
+        if(caps[m]) atlib_bufread_setbuf(&br, NULL, caps[m]);
+        test_check(atlib_bufrecord_decode(&wide, &br, __wides, N + 1) == N);
+        __check_wides(__data, N);
+        test_check(atlib_bufread_pos(&br) == N * 21);
+        atlib_bufread_close(&br);
+    }
+
+    /* Encoding writes the same bytes back, with zeros where no field is */
+    bufwrite_t bw;
+    atlib_bufwrite_memopen(&bw);
+    atlib_bufwrite_setbuf(&bw, NULL, 37);
+    test_check(atlib_bufrecord_encode(&tick, &bw, __ticks, N) == N);
+    test_check(atlib_bufrecord_encode(&wide, &bw, __wides, N) == N);
+
+    usize len;
+    const u8 * out = (const u8 *)atlib_bufwrite_membuf(&bw, &len);
+    test_check(len == N * 16 + N * 21);
+    usize diff = 0;
+    for(usize k = 0; k < N * 16 && len == N * 37; k++) diff += out[k] != (k % 16 == 7 ? 0 : __data[k]);
+    for(usize k = 0; k < N * 21 && len == N * 37; k++) {
+        const usize r = k % 21;
+        diff += out[N * 16 + k] != (r == 10 || r == 11 || r == 20 ? 0 : __data[k]);
+    }
+    test_check(diff == 0);
+    atlib_bufwrite_close(&bw);
+
+    atlib_bufrecord_free(&tick);
+    atlib_bufrecord_free(&wide);
+    remove(test_file("record.bin"));
+    return test_done();
+}
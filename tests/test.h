@@ -0,0 +1,36 @@
+#ifndef __ATLIB_TEST_H
+#define __ATLIB_TEST_H
+
+/**
+ * @file test.h
+ * Shared checks for the tests in this directory; each test is a program that exits non-zero on a failed check.
+ */
+
+#include <stdio.h>
+
+static int __test_failed = 0;
+
+/**
+ * @def test_check(e)
+ * @brief Reports the file and line of @c e if it is false, and marks the test as failed without stopping it.
+ */
+#define test_check(e) do { \
+    if(!(e)) { \
+        fprintf(stderr, "%s:%d: check `%s` failed\n", __FILE__, __LINE__, #e); \
+        __test_failed = 1; \
+    } \
+} while(0)
+
+/**
+ * @def test_file(name)
+ * @brief Path of the scratch file @c name, for tests that need a stream backed by a file.
+ */
+#define test_file(name) ("/tmp/atlib_test_" name)
+
+/**
+ * @def test_done()
+ * @brief Exit status of the test: 0 if every check passed, 1 otherwise.
+ */
+#define test_done() (__test_failed)
+
+#endif
@@ -0,0 +1,77 @@
+#include <Atlib.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "test.h"
+
+#define N 4096
+
+static u64 __u[N];
+static i64 __s[N];
+
+int main(void) {
+    /* Every length from 1 to 10 bytes, both signs, and the extremes */
+    for(usize k = 0; k < N; k++) {
+        const u64 v = ((u64)rand() << 42) ^ ((u64)rand() << 21) ^ (u64)rand() ^ ((u64)rand() << 62);
+        __u[k] = v >> (k % 64);
+        __s[k] = k % 2 ? -(i64)(__u[k] >> 1) : (i64)(__u[k] >> 1);
+    }
+    __u[0] = 0; __u[1] = 127; __u[2] = 128; __u[3] = UINT64_MAX;
+    __s[0] = 0; __s[1] = -1; __s[2] = INT64_MIN; __s[3] = INT64_MAX;
+
+    /* Writers append, so start from an empty file */
+    bufwrite_t bw;
+    remove(test_file("varint.bin"));
+    test_check(atlib_bufwrite_open_ex(&bw, test_file("varint.bin"), BUFWRITE_FD));
+    atlib_bufwrite_setbuf(&bw, NULL, 13);
+    for(usize k = 0; k < N; k++) {
+        atlib_bufwrite_write_uvarint(&bw, __u[k]);
+        atlib_bufwrite_write_svarint(&bw, __s[k]);
+    }
+    atlib_bufwrite_close(&bw);
+
+    const u32 flags[] = {0, BUFREAD_FD, BUFREAD_MMAP};
+    for(usize m = 0; m < sizeof(flags) / sizeof(*flags); m++) {
+        bufread_t br;
+        test_check(atlib_bufread_open(&br, test_file("varint.bin"), flags[m]));
+        if(!(flags[m] & BUFREAD_MMAP)) atlib_bufread_setbuf(&br, NULL, 13);
+
+        usize bad = 0;
+        for(usize k = 0; k < N; k++) {
+            u64 u;
+            i64 s;
+            bad += atlib_bufread_read_uvarint_array(&br, &u, 1) != 1 || u != __u[k];
+            bad += atlib_bufread_read_svarint_array(&br, &s, 1) != 1 || s != __s[k];
+        }
+        test_check(bad == 0);
+        test_check(atlib_bufread_read_uvarint(&br) == 0);
+        test_check(atlib_bufread_eof(&br));
+        atlib_bufread_close(&br);
+    }
+
+    /* The bulk reader stops at the end of the stream */
+    usize len;
+    atlib_bufwrite_memopen(&bw);
+    for(usize k = 0; k < N; k++) atlib_bufwrite_write_uvarint(&bw, __u[k]);
+    char * mem = atlib_bufwrite_memtake(&bw, &len);
+    atlib_bufwrite_close(&bw);
+
+    static u64 out[N + 8];
+    bufread_t br;
+    atlib_bufread_memopen(&br, mem, len, 0);
+    test_check(atlib_bufread_read_uvarint_array(&br, out, 100) == 100);
+    test_check(atlib_bufread_read_uvarint_array(&br, out + 100, N + 8 - 100) == N - 100);
+    usize bad = 0;
+    for(usize k = 0; k < N; k++) bad += out[k] != __u[k];
+    test_check(bad == 0);
+    atlib_bufread_close(&br);
+    free(mem);
+
+    /* A varint cut short by the end of the stream reads as 0 */
+    const u8 cut[] = {0x81, 0x82};
+    atlib_bufread_memopen(&br, cut, sizeof(cut), 0);
+    test_check(atlib_bufread_read_uvarint(&br) == 0);
+    atlib_bufread_close(&br);
+
+    remove(test_file("varint.bin"));
+    return test_done();
+}
@@ -0,0 +1,92 @@
+#include <Atlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "test.h"
+
+static char __exp[1 << 16];
+static usize __len;
+
+/* Writes the same format with snprintf, to compare against */
+#define check_writef(bw, ...) do { \
+    const int n = snprintf(__exp + __len, sizeof(__exp) - __len, __VA_ARGS__); \
+    test_check(atlib_bufwrite_writef(bw, __VA_ARGS__) == (usize)n); \
+    __len += n; \
+} while(0)
+
+static void __write_formats(bufwrite_t * bw) {
+    const char * ints[] = {"<%d>", "<%-6i>", "<%+05d>", "<% d>", "<%.3d>", "<%8.3d>", "<%x>", "<%#X>", "<%#o>", "<%u>"};
+    const int ivals[] = {0, 1, -1, 42, -32768, INT32_MAX, INT32_MIN};
+    for(usize f = 0; f < sizeof(ints) / sizeof(*ints); f++) {
+        for(usize k = 0; k < sizeof(ivals) / sizeof(*ivals); k++) check_writef(bw, ints[f], ivals[k]);
+    }
+
+    check_writef(bw, "<%ld|%lu|%lx>", (long)INT64_MIN, (unsigned long)UINT64_MAX, (unsigned long)0xdeadbeef);
+    check_writef(bw, "<%lld|%hhd|%hu|%zu|%jd|%td>", (long long)-7, 300, 70000, (size_t)12, (intmax_t)-3, (ptrdiff_t)5);
+
+    const double dvals[] = {0, -0.0, 1.5, -3.25e-7, 1e300, 123456.789};
+    for(usize k = 0; k < sizeof(dvals) / sizeof(*dvals); k++) {
+        check_writef(bw, "<%f|%.2e|%g|%12.4G|%a>", dvals[k], dvals[k], dvals[k], dvals[k], dvals[k]);
+    }
+    check_writef(bw, "<%.300f>", 1.0);
+
+    check_writef(bw, "<%s|%-12s|%.3s|%c|%%>", "hello", "left", "truncated", 'Q');
+    check_writef(bw, "<%*d|%-*d|%.*f|%*.*s>", 8, 42, 8, 42, 3, 3.14159, -10, 2, "abcdef");
+    check_writef(bw, "<%p>", (void *)0x7ffd1234);
+    check_writef(bw, "a longer run of plain text without any conversion in it, so that it spans a few flushes");
+}
+
+int main(void) {
+    /* Against a buffer smaller than most outputs, a moderate one, and the default */
+    const usize caps[] = {7, 100, 0};
+    for(usize m = 0; m < sizeof(caps) / sizeof(*caps); m++) {
+        /* Writers append, so each run starts from an empty file */
+        bufwrite_t bw;
+        remove(test_file("writef.txt"));
+        test_check(atlib_bufwrite_open_ex(&bw, test_file("writef.txt"), BUFWRITE_FD));
+        if(caps[m]) atlib_bufwrite_setbuf(&bw, NULL, caps[m]);
+
+        __len = 0;
+        __write_formats(&bw);
+        atlib_bufwrite_close(&bw);
+
+        static char got[sizeof(__exp)];
+        FILE * fh = fopen(test_file("writef.txt"), "rb");
+        const usize n = fread(got, 1, sizeof(got), fh);
+        fclose(fh);
+        test_check(n == __len && memcmp(got, __exp, __len) == 0);
+    }
+
+    bufwrite_t bw;
+    usize len;
+    atlib_bufwrite_memopen(&bw);
+
+    int count = -1;
+    test_check(atlib_bufwrite_writef(&bw, "abc%n", &count) == 3);
+    test_check(count == 3);
+
+    /* A trailing % has no conversion after it, and is written as it is; kept out of string
+       literals so that the compiler does not flag the formats */
+    const char * trailing = "ab%";
+    atlib_bufwrite_memreset(&bw);
+    test_check(atlib_bufwrite_writef(&bw, trailing, 0) == 3);
+    const char * out = atlib_bufwrite_membuf(&bw, &len);
+    test_check(len == 3 && memcmp(out, "ab%", 3) == 0);
+
+    trailing = "%d%";
+    atlib_bufwrite_memreset(&bw);
+    test_check(atlib_bufwrite_writef(&bw, trailing, 5) == 2);
+    out = atlib_bufwrite_membuf(&bw, &len);
+    test_check(len == 2 && memcmp(out, "5%", 2) == 0);
+
+    /* Nor does a length modifier with nothing after it read past the format */
+    trailing = "x%l";
+    atlib_bufwrite_memreset(&bw);
+    test_check(atlib_bufwrite_writef(&bw, trailing, 0) == 3);
+    out = atlib_bufwrite_membuf(&bw, &len);
+    test_check(len == 3 && memcmp(out, "x%l", 3) == 0);
+
+    atlib_bufwrite_close(&bw);
+    remove(test_file("writef.txt"));
+    return test_done();
+}
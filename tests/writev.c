@@ -0,0 +1,112 @@
+#include <Atlib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include "test.h"
+
+#define SRC_LEN (1 << 20)
+#define EXP_LEN (1 << 23)
+
+static char __src[SRC_LEN + 200000];
+static char __exp[EXP_LEN];
+static char __got[EXP_LEN];
+
+/* Writes small pieces, pieces larger than the buffer, and vectors longer than one writev batch */
+static usize __write_mix(bufwrite_t * bw, u32 seed) {
+    usize e = 0;
+    srand(seed);
+    for(usize i = 0; i < 1500 && e < EXP_LEN - 500000; i++) {
+        const usize off = (usize)rand() % SRC_LEN;
+        usize n = 0;
+
+        switch(rand() % 4) {
+            case 0:
+                n = (usize)rand() % 100;
+                break;
+            case 1:
+                n = (usize)rand() % 4096 + 1;
+                break;
+            case 2:
+                n = i % 10 == 0 ? (usize)rand() % 100000 + 4096 : 0;
+                break;
+            default: {
+                struct iovec iov[150];
+                const i32 cnt = rand() % 150;
+                usize total = 0;
+                for(i32 k = 0; k < cnt; k++) {
+                    iov[k].iov_base = __src + rand() % SRC_LEN;
+                    iov[k].iov_len = rand() % 3 ? (usize)rand() % 50 : (usize)rand() % 3000;
+                    memcpy(__exp + e + total, iov[k].iov_base, iov[k].iov_len);
+                    total += iov[k].iov_len;
+                }
+                test_check(atlib_bufwrite_writev(bw, iov, cnt) == total);
+                e += total;
+                continue;
+            }
+        }
+
+        test_check(atlib_bufwrite_write(bw, __src + off, n) == n);
+        memcpy(__exp + e, __src + off, n);
+        e += n;
+
+        if(rand() % 50 == 0) {
+            atlib_bufwrite_write_u32(bw, 0x01020304);
+            memcpy(__exp + e, "\1\2\3\4", 4);
+            e += 4;
+        }
+    }
+    return e;
+}
+
+static int __file_is(const char * path, usize len) {
+    FILE * fh = fopen(path, "rb");
+    const usize n = fread(__got, 1, sizeof(__got), fh);
+    fclose(fh);
+    return n == len && memcmp(__got, __exp, len) == 0;
+}
+
+int main(void) {
+    for(usize k = 0; k < sizeof(__src); k++) __src[k] = (char)rand();
+
+    /* A file descriptor and a FILE *, each with a buffer smaller than most writes and the default one */
+    const usize caps[] = {7, 0};
+    for(usize m = 0; m < 4; m++) {
+        bufwrite_t bw;
+        remove(test_file("writev.bin"));
+        if(m < 2) test_check(atlib_bufwrite_open_ex(&bw, test_file("writev.bin"), BUFWRITE_FD));
+        else test_check(atlib_bufwrite_open(&bw, test_file("writev.bin")));
+        if(caps[m % 2]) atlib_bufwrite_setbuf(&bw, NULL, caps[m % 2]);
+
+        const usize len = __write_mix(&bw, (u32)m);
+        test_check(atlib_bufwrite_pos(&bw) == len);
+        atlib_bufwrite_close(&bw);
+        test_check(__file_is(test_file("writev.bin"), len));
+    }
+
+    /* Memory streams grow to take everything */
+    bufwrite_t bw;
+    usize len;
+    atlib_bufwrite_memopen(&bw);
+    const usize e = __write_mix(&bw, 4);
+    const char * mem = atlib_bufwrite_membuf(&bw, &len);
+    test_check(len == e && memcmp(mem, __exp, e) == 0);
+    atlib_bufwrite_close(&bw);
+
+    /* Flushes queued on an io_uring ring land in order, where the kernel has one */
+    uring_t ring;
+    if(atlib_uring_open(&ring, 8)) {
+        remove(test_file("writev.bin"));
+        test_check(atlib_bufwrite_open_ex(&bw, test_file("writev.bin"), BUFWRITE_FD));
+        if(atlib_bufwrite_uring(&bw, &ring)) {
+            len = __write_mix(&bw, 5);
+            atlib_bufwrite_close(&bw);
+            test_check(__file_is(test_file("writev.bin"), len));
+        }
+        else atlib_bufwrite_close(&bw);
+        atlib_uring_close(&ring);
+    }
+
+    remove(test_file("writev.bin"));
+    return test_done();
+}